@@ -289,7 +289,8 @@ public:
         auto* self = std::any_cast<Test*>(userPtr);
         struct {
             GLint shader, vao, vbo, ebo, texture, blendsrc, blenddst;
-            GLboolean depthtest, stenciltest, blend;
+            GLboolean depthtest, stenciltest, blend, scissortest;
+            GLint viewport[4];
         } last;
         glGetIntegerv(GL_CURRENT_PROGRAM, &last.shader);
         glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last.vao);
@@ -301,36 +302,57 @@ public:
         glGetBooleanv(GL_DEPTH_TEST, &last.depthtest);
         glGetBooleanv(GL_STENCIL_TEST, &last.stenciltest);
         glGetBooleanv(GL_BLEND, &last.blend);
+        glGetBooleanv(GL_SCISSOR_TEST, &last.scissortest);
+        glGetIntegerv(GL_VIEWPORT, last.viewport);
         
         self->gui.shader.use();
         glBindVertexArray(self->gui.vao);
         glBindBuffer(GL_ARRAY_BUFFER, self->gui.vbo);
+        using reig::primitive::DrawVertex;
         glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(reig::primitive::Vertex), nullptr);
         glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(reig::primitive::Vertex), (void*)(offsetof(reig::primitive::Vertex, texCoord)));
         glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(reig::primitive::Vertex), (void*)(offsetof(reig::primitive::Vertex, color)));
+        if constexpr (std::is_same_v<DrawVertex, reig::primitive::CompactVertex>) {
+            glVertexAttribPointer(0, 2, GL_SHORT, GL_FALSE, sizeof(DrawVertex), nullptr);
+            glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(DrawVertex), (void*)(offsetof(DrawVertex, u)));
+        } else {
+            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(DrawVertex), nullptr);
+            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(DrawVertex), (void*)(offsetof(DrawVertex, texCoord)));
+        }
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(DrawVertex), (void*)(offsetof(DrawVertex, color)));
         
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, self->gui.ebo);
+        bool isQuadList = drawData.geometry_output() == reig::primitive::GeometryOutput::kQuadList;
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, isQuadList ? self->gui.quadEbo : self->gui.ebo);
         
         glDisable(GL_DEPTH_TEST);
         glDisable(GL_STENCIL_TEST);
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glEnable(GL_SCISSOR_TEST);
+        
+        auto const& vertices = drawData.vertices();
+        auto const& indices = drawData.indices();
+        GLenum indexType = sizeof(indices[0]) == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices[0]) * vertices.size(), vertices.data(), GL_STREAM_DRAW);
+        if(!isQuadList) {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices[0]) * indices.size(), indices.data(), GL_STREAM_DRAW);
+        }
         
-        for(auto const& figure : drawData) {
-            auto const& vertices = figure.vertices().data();
-            auto const& indices  = figure.indices().data();
-            auto vnumber = figure.vertices().size();
-            auto inumber = figure.indices().size();
+        for(auto const& command : drawData.commands()) {
+            glUniform1ui(self->gui.shader.uniform("fragTexId"), command.texture_id);
+            glBindTexture(GL_TEXTURE_2D, command.texture_id);
+            auto const& transform = command.transform;
+            glUniform2f(self->gui.shader.uniform("vertexTranslation"), transform.translation.x, transform.translation.y);
+            glUniform1f(self->gui.shader.uniform("vertexScale"), transform.scale);
             
-            glUniform1ui(self->gui.shader.uniform("fragTexId"), figure.texture());
-            glBindTexture(GL_TEXTURE_2D, figure.texture());
+            // The clip rectangle has its origin at the top left, unlike the scissor box
+            auto const clip = reig::primitive::transform_rect(transform, command.clip_rect);
+            glScissor(static_cast<GLint>(clip.x),
+                      static_cast<GLint>(last.viewport[3] - (clip.y + clip.height)),
+                      static_cast<GLsizei>(clip.width), static_cast<GLsizei>(clip.height));
             
-            glBufferData(GL_ARRAY_BUFFER, sizeof(vertices[0]) * vnumber, vertices, GL_STATIC_DRAW);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices[0]) * inumber, indices, GL_STATIC_DRAW);
-            glDrawElements(GL_TRIANGLES, inumber, GL_UNSIGNED_INT, nullptr);
+            auto* offset = (void*)(sizeof(indices[0]) * command.index_offset);
+            glDrawElementsBaseVertex(GL_TRIANGLES, command.index_count, indexType, offset, command.vertex_offset);
         }
         
         glUseProgram(last.shader);
@@ -340,6 +362,7 @@ public:
         glBindTexture(GL_TEXTURE_2D, last.texture);
         if(last.depthtest) glEnable(GL_DEPTH_TEST);
         if(last.stenciltest) glEnable(GL_STENCIL_TEST);
+        if(!last.scissortest) glDisable(GL_SCISSOR_TEST);
         if(!last.blend) glDisable(GL_BLEND);
         else glBlendFunc(last.blendsrc, last.blenddst);
     }
@@ -376,6 +399,12 @@ public:
         glCreateVertexArrays(1, &gui.vao);
         glCreateBuffers(1, &gui.vbo);
         glCreateBuffers(1, &gui.ebo);
+        glCreateBuffers(1, &gui.quadEbo);
+        
+        auto const& quadIndices = reig::primitive::get_quad_list_indices();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gui.quadEbo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(quadIndices[0]) * quadIndices.size(), quadIndices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
         
         gui.shader.use();
         glUniformMatrix4fv(
@@ -462,12 +491,13 @@ private:
     
     struct gui {
         ShaderProgram shader;
-        GLuint vao {}, vbo {}, ebo {};
+        GLuint vao {}, vbo {}, ebo {}, quadEbo {};
         
         ~gui() {
             if(vao) glDeleteVertexArrays(1, &vao);
             if(vbo) glDeleteBuffers(1, &vbo);
             if(ebo) glDeleteBuffers(1, &ebo);
+            if(quadEbo) glDeleteBuffers(1, &quadEbo);
         }
     }
     gui;
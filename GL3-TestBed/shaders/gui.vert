@@ -5,12 +5,14 @@ layout (location = 1) in vec2 vertTexPos;
 layout (location = 2) in vec4 vertColor;
 
 uniform mat4 vertexProjection;
+uniform vec2 vertexTranslation;
+uniform float vertexScale;
 
 out vec2 fragTexPos;
 out vec4 fragColor;
 
 void main() {
-    gl_Position = vertexProjection * vec4(vertPos, 0.0, 1.0);
+    gl_Position = vertexProjection * vec4(vertPos * vertexScale + vertexTranslation, 0.0, 1.0);
     fragColor = vertColor;
     fragTexPos = vertTexPos;
 }
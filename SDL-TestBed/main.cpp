@@ -96,6 +96,7 @@ private:
                                     .set_font_bitmap_size(1024, 1024)
                                     .set_window_colors(colors::kRed | 200_a, colors::kMediumGrey | 150_a)
                                     .build());
+        _gui.ctx.set_viewport_size(static_cast<float>(_sdl.width), static_cast<float>(_sdl.height));
         _gui.ctx.set_render_handler(&gui_handler);
         _gui.ctx.set_user_ptr(this);
 
@@ -142,42 +143,68 @@ private:
         auto* self = std::any_cast<Main*>(user_ptr);
         namespace colors = reig::primitive::colors;
 
-        for (auto const& fig : draw_data) {
-            auto const& vertices = fig.vertices();
-            auto const& indices = fig.indices();
-            auto number = indices.size();
+        auto const& vertices = draw_data.vertices();
+        auto const& indices = draw_data.indices();
+        for (auto const& command : draw_data.commands()) {
+            auto const* command_vertices = vertices.data() + command.vertex_offset;
+            auto const* command_indices = indices.data() + command.index_offset;
+            auto number = command.index_count;
 
             if (number % 3 != 0) {
                 continue;
             }
 
-            if (fig.texture() == 0) {
-                for (auto i = 0ul; i < number; i += 3) {
+            auto const& transform = command.transform;
+            auto to_screen = [&transform](primitive::Point point) {
+                return primitive::transform_point(transform, point);
+            };
+
+            auto const clip_rect = primitive::transform_rect(transform, command.clip_rect);
+            SDL_Rect clip;
+            clip.x = static_cast<int>(clip_rect.x);
+            clip.y = static_cast<int>(clip_rect.y);
+            clip.w = static_cast<int>(clip_rect.width);
+            clip.h = static_cast<int>(clip_rect.height);
+            SDL_RenderSetClipRect(self->_sdl.renderer, &clip);
+
+            if (command.texture_id == 0) {
+                for (auto i = 0u; i < number; i += 3) {
+                    auto const& v0 = command_vertices[command_indices[i]];
+                    auto p0 = to_screen(primitive::get_position(v0));
+                    auto p1 = to_screen(primitive::get_position(command_vertices[command_indices[i + 1]]));
+                    auto p2 = to_screen(primitive::get_position(command_vertices[command_indices[i + 2]]));
                     filledTrigonColor(
                             self->_sdl.renderer,
-                            static_cast<Sint16>(vertices[indices[i]].position.x),
-                            static_cast<Sint16>(vertices[indices[i]].position.y),
-                            static_cast<Sint16>(vertices[indices[i + 1]].position.x),
-                            static_cast<Sint16>(vertices[indices[i + 1]].position.y),
-                            static_cast<Sint16>(vertices[indices[i + 2]].position.x),
-                            static_cast<Sint16>(vertices[indices[i + 2]].position.y),
-                            colors::to_uint(vertices[i].color)
+                            static_cast<Sint16>(p0.x),
+                            static_cast<Sint16>(p0.y),
+                            static_cast<Sint16>(p1.x),
+                            static_cast<Sint16>(p1.y),
+                            static_cast<Sint16>(p2.x),
+                            static_cast<Sint16>(p2.y),
+                            colors::to_uint(v0.color)
                     );
                 }
-            } else if (fig.texture() == self->_gui.font.font_texture_id) {
-                SDL_Rect src;
-                src.x = static_cast<int>(vertices[0].texCoord.x * self->_gui.font.font_bitmap.width);
-                src.y = static_cast<int>(vertices[0].texCoord.y * self->_gui.font.font_bitmap.height);
-                src.w = static_cast<int>(vertices[2].texCoord.x * self->_gui.font.font_bitmap.width - src.x);
-                src.h = static_cast<int>(vertices[2].texCoord.y * self->_gui.font.font_bitmap.height - src.y);
-                SDL_Rect dst;
-                dst.x = static_cast<int>(vertices[0].position.x);
-                dst.y = static_cast<int>(vertices[0].position.y);
-                dst.w = static_cast<int>(vertices[2].position.x - dst.x);
-                dst.h = static_cast<int>(vertices[2].position.y - dst.y);
-                SDL_RenderCopy(self->_sdl.renderer, self->_gui.font.texture, &src, &dst);
+            } else if (command.texture_id == self->_gui.font.font_texture_id) {
+                for (auto i = 0u; i + 3 < command.vertex_count; i += 4) {
+                    auto top_left = to_screen(primitive::get_position(command_vertices[i]));
+                    auto bottom_right = to_screen(primitive::get_position(command_vertices[i + 2]));
+                    auto top_left_uv = primitive::get_tex_coord(command_vertices[i]);
+                    auto bottom_right_uv = primitive::get_tex_coord(command_vertices[i + 2]);
+                    SDL_Rect src;
+                    src.x = static_cast<int>(top_left_uv.x * self->_gui.font.font_bitmap.width);
+                    src.y = static_cast<int>(top_left_uv.y * self->_gui.font.font_bitmap.height);
+                    src.w = static_cast<int>(bottom_right_uv.x * self->_gui.font.font_bitmap.width - src.x);
+                    src.h = static_cast<int>(bottom_right_uv.y * self->_gui.font.font_bitmap.height - src.y);
+                    SDL_Rect dst;
+                    dst.x = static_cast<int>(top_left.x);
+                    dst.y = static_cast<int>(top_left.y);
+                    dst.w = static_cast<int>(bottom_right.x - dst.x);
+                    dst.h = static_cast<int>(bottom_right.y - dst.y);
+                    SDL_RenderCopy(self->_sdl.renderer, self->_gui.font.texture, &src, &dst);
+                }
             }
         }
+        SDL_RenderSetClipRect(self->_sdl.renderer, nullptr);
     }
 
     bool handle_input_events() {
@@ -9,6 +9,15 @@ namespace reig {
         _title_bar_bg_color = builder.title_bar_bg_color();
         _font_bitmap_width = builder.font_bitmap_width();
         _font_bitmap_height = builder.font_bitmap_height();
+        _command_reordering = builder.command_reordering();
+        _command_culling = builder.command_culling();
+        _window_caching = builder.window_caching();
+        _window_occlusion = builder.window_occlusion();
+        _change_tracking = builder.change_tracking();
+        _geometry_output = builder.geometry_output();
+        _vertex_streams = builder.vertex_streams();
+        _frame_submission = builder.frame_submission();
+        _frame_slot_count = builder.frame_slot_count();
     }
 
     const primitive::Color& Config::window_bg_color() const {
@@ -55,6 +64,42 @@ namespace reig {
         return _font_bitmap_height;
     }
 
+    bool Config::command_reordering() const {
+        return _command_reordering;
+    }
+
+    bool Config::command_culling() const {
+        return _command_culling;
+    }
+
+    bool Config::window_caching() const {
+        return _window_caching;
+    }
+
+    bool Config::window_occlusion() const {
+        return _window_occlusion;
+    }
+
+    bool Config::change_tracking() const {
+        return _change_tracking;
+    }
+
+    primitive::GeometryOutput Config::geometry_output() const {
+        return _geometry_output;
+    }
+
+    primitive::VertexStreams Config::vertex_streams() const {
+        return _vertex_streams;
+    }
+
+    FrameSubmission Config::frame_submission() const {
+        return _frame_submission;
+    }
+
+    int Config::frame_slot_count() const {
+        return _frame_slot_count;
+    }
+
     Config::Builder::Builder() = default;
 
     Config Config::Builder::build() {
@@ -84,6 +129,49 @@ namespace reig {
         return *this;
     }
 
+    Config::Builder& Config::Builder::set_command_reordering(bool enabled) {
+        _command_reordering = enabled;
+        return *this;
+    }
+
+    Config::Builder& Config::Builder::set_command_culling(bool enabled) {
+        _command_culling = enabled;
+        return *this;
+    }
+
+    Config::Builder& Config::Builder::set_window_caching(bool enabled) {
+        _window_caching = enabled;
+        return *this;
+    }
+
+    Config::Builder& Config::Builder::set_window_occlusion(bool enabled) {
+        _window_occlusion = enabled;
+        return *this;
+    }
+
+    Config::Builder& Config::Builder::set_change_tracking(bool enabled) {
+        _change_tracking = enabled;
+        return *this;
+    }
+
+    Config::Builder& Config::Builder::set_geometry_output(primitive::GeometryOutput geometry_output) {
+        _geometry_output = geometry_output;
+        return *this;
+    }
+
+    Config::Builder& Config::Builder::set_vertex_streams(primitive::VertexStreams vertex_streams) {
+        _vertex_streams = vertex_streams;
+        return *this;
+    }
+
+    Config::Builder& Config::Builder::set_frame_submission(FrameSubmission frame_submission, int slot_count) {
+        // With less than two slots the UI thread would have to wait for the render thread
+        if (slot_count < 2) throw std::invalid_argument{"slot count must be at least 2"};
+        _frame_submission = frame_submission;
+        _frame_slot_count = slot_count;
+        return *this;
+    }
+
     const primitive::Color& Config::Builder::window_bg_color() const {
         return _window_bg_color;
     }
@@ -111,4 +199,40 @@ namespace reig {
     int Config::Builder::font_bitmap_height() const {
         return _font_bitmap_height;
     }
-}
\ No newline at end of file
+
+    bool Config::Builder::command_reordering() const {
+        return _command_reordering;
+    }
+
+    bool Config::Builder::command_culling() const {
+        return _command_culling;
+    }
+
+    bool Config::Builder::window_caching() const {
+        return _window_caching;
+    }
+
+    bool Config::Builder::window_occlusion() const {
+        return _window_occlusion;
+    }
+
+    bool Config::Builder::change_tracking() const {
+        return _change_tracking;
+    }
+
+    primitive::GeometryOutput Config::Builder::geometry_output() const {
+        return _geometry_output;
+    }
+
+    primitive::VertexStreams Config::Builder::vertex_streams() const {
+        return _vertex_streams;
+    }
+
+    FrameSubmission Config::Builder::frame_submission() const {
+        return _frame_submission;
+    }
+
+    int Config::Builder::frame_slot_count() const {
+        return _frame_slot_count;
+    }
+}
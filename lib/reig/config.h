@@ -3,6 +3,7 @@
 
 #include "context_fwd.h"
 #include "primitive.h"
+#include "draw_list.h"
 
 namespace reig {
     enum class FillMode {
@@ -10,6 +11,11 @@ namespace reig {
         kTextured,
     };
 
+    enum class FrameSubmission {
+        kImmediate, // end_frame passes the layers to the render handler
+        kBuffered,  // end_frame publishes a snapshot of the frame, for a render thread to acquire
+    };
+
     class Config {
     public:
         class Builder;
@@ -49,6 +55,53 @@ namespace reig {
 
         int font_bitmap_height() const;
 
+        /**
+         * @return Whether the windows' commands are grouped by texture, where it doesn't change the result
+         */
+        bool command_reordering() const;
+
+        /**
+         * @return Whether the commands, that can't be seen, are dropped before the render handler gets them
+         */
+        bool command_culling() const;
+
+        /**
+         * @return Whether the windows reuse their geometry from the last frame, while their widgets render the same
+         */
+        bool window_caching() const;
+
+        /**
+         * @return Whether the widgets of a window, that is covered by opaque windows above it, are only recorded
+         * and their geometry is dropped, once the window is still covered at the end of the frame
+         */
+        bool window_occlusion() const;
+
+        /**
+         * @return Whether the layers are hashed, to tell which of them are the same as in the last frame.
+         * Without it no layer or frame is reported unchanged, and every layer damages its whole area
+         */
+        bool change_tracking() const;
+
+        /**
+         * @return The form in which the draw lists hold their geometry
+         */
+        primitive::GeometryOutput geometry_output() const;
+
+        /**
+         * @return Whether the draw lists hold interleaved vertices or separate vertex attribute arrays
+         */
+        primitive::VertexStreams vertex_streams() const;
+
+        /**
+         * @return How the finished frames are handed to the backend
+         */
+        FrameSubmission frame_submission() const;
+
+        /**
+         * @return The number of frame snapshots, that are kept for the render thread in the buffered submission
+         */
+        int frame_slot_count() const;
+
         class Builder {
         public:
             Builder();
@@ -62,6 +115,25 @@ namespace reig {
 
             Builder& set_font_bitmap_size(int width, int height);
 
+            Builder& set_command_reordering(bool enabled);
+
+            Builder& set_command_culling(bool enabled);
+
+            Builder& set_window_caching(bool enabled);
+
+            Builder& set_window_occlusion(bool enabled);
+
+            Builder& set_change_tracking(bool enabled);
+
+            Builder& set_geometry_output(primitive::GeometryOutput geometry_output);
+
+            Builder& set_vertex_streams(primitive::VertexStreams vertex_streams);
+
+            /**
+             * @param slot_count The snapshots kept in the buffered submission, 2 for double and 3 for triple buffering
+             */
+            Builder& set_frame_submission(FrameSubmission frame_submission, int slot_count = 3);
+
             const primitive::Color& window_bg_color() const;
 
             const primitive::Color& title_bar_bg_color() const;
@@ -76,6 +148,24 @@ namespace reig {
 
             int font_bitmap_height() const;
 
+            bool command_reordering() const;
+
+            bool command_culling() const;
+
+            bool window_caching() const;
+
+            bool window_occlusion() const;
+
+            bool change_tracking() const;
+
+            primitive::GeometryOutput geometry_output() const;
+
+            primitive::VertexStreams vertex_streams() const;
+
+            FrameSubmission frame_submission() const;
+
+            int frame_slot_count() const;
+
         private:
             FillMode _fill_mode = FillMode::kColored;
             int _window_bg_texture_id = 0;
@@ -84,6 +174,15 @@ namespace reig {
             primitive::Color _title_bar_bg_color;
             int _font_bitmap_width = 512;
             int _font_bitmap_height = 512;
+            bool _command_reordering = false;
+            bool _command_culling = false;
+            bool _window_caching = false;
+            bool _window_occlusion = false;
+            bool _change_tracking = false;
+            primitive::GeometryOutput _geometry_output = primitive::GeometryOutput::kIndexed;
+            primitive::VertexStreams _vertex_streams = primitive::VertexStreams::kInterleaved;
+            FrameSubmission _frame_submission = FrameSubmission::kImmediate;
+            int _frame_slot_count = 3;
         };
 
     private:
@@ -98,6 +197,15 @@ namespace reig {
         primitive::Color _title_bar_bg_color;
         int _font_bitmap_width;
         int _font_bitmap_height;
+        bool _command_reordering;
+        bool _command_culling;
+        bool _window_caching;
+        bool _window_occlusion;
+        bool _change_tracking;
+        primitive::GeometryOutput _geometry_output;
+        primitive::VertexStreams _vertex_streams;
+        FrameSubmission _frame_submission;
+        int _frame_slot_count;
     };
 }
 
@@ -4,8 +4,12 @@
 #include "context.h"
 #include "exception.h"
 #include "maths.h"
+#include "tessellation.h"
+#include "hash.h"
 #include <memory>
 #include <algorithm>
+#include <cstring>
+#include <cstddef>
 
 using namespace reig::primitive;
 using reig::detail::Window;
@@ -17,10 +21,27 @@ namespace reig {
     Context::Context() : Context{Config::Builder{}.build()} {}
 
     Context::Context(const Config& config)
-            : mouse{*this}, _config{config} {}
+            : mouse{*this}, _free_draw_data{&_frame_arena}, _chrome_draw_data{&_frame_arena},
+              _draw_calls{&_frame_arena}, _deferred_draw_calls{&_frame_arena}, _config{config} {
+        configure_frame_ring();
+    }
 
     void Context::set_config(const Config& config) {
         _config = config;
+        ++_cache_generation;
+        configure_frame_ring();
+    }
+
+    void Context::configure_frame_ring() {
+        auto slot_count = _config.frame_submission() == FrameSubmission::kBuffered
+                          ? static_cast<std::size_t>(_config.frame_slot_count())
+                          : std::size_t{0};
+        if (slot_count == _frame_ring.slot_count()) return;
+
+        _frame_ring = detail::FrameRing{slot_count};
+        _frame_snapshots.clear();
+        _frame_snapshots.resize(slot_count);
+        _acquired_slot = detail::FrameRing::kNoSlot;
     }
 
     void Context::set_render_handler(RenderHandler render_handler) {
@@ -83,6 +104,7 @@ namespace reig {
         _font.bitmap_width = bitmap_width;
         _font.bitmap_height = bitmap_height;
         _font.height = font_height_in_px;
+        ++_cache_generation;
 
         return FontBitmap{bitmap, bitmap_width, bitmap_height};
     }
@@ -91,18 +113,206 @@ namespace reig {
         return _font.height;
     }
 
+    /**
+     * @return The area of the screen, that the layer's commands may draw to
+     */
+    Rectangle get_layer_screen_rect(const DrawData& draw_data) {
+        Rectangle layer_rect;
+        bool is_empty = true;
+        for (const auto& command : draw_data.commands()) {
+            auto visible_rect = get_overlapping_rect(command.bounds, command.clip_rect);
+            if (visible_rect.width <= 0.0f || visible_rect.height <= 0.0f) continue;
+
+            auto screen_rect = transform_rect(command.transform, visible_rect);
+            layer_rect = is_empty ? screen_rect : get_bounding_rect(layer_rect, screen_rect);
+            is_empty = false;
+        }
+        return layer_rect;
+    }
+
+    /**
+     * @brief Joins the overlapping rects, until none of them overlap
+     */
+    void merge_damage_rects(std::vector<Rectangle>& rects) {
+        bool has_merged = true;
+        while (has_merged) {
+            has_merged = false;
+            for (std::size_t i = 0; i < rects.size(); ++i) {
+                for (std::size_t j = i + 1; j < rects.size(); ++j) {
+                    if (is_rect_overlapping(rects[i], rects[j])) {
+                        rects[i] = get_bounding_rect(rects[i], rects[j]);
+                        rects.erase(rects.begin() + static_cast<std::ptrdiff_t>(j));
+                        has_merged = true;
+                        --j;
+                    }
+                }
+            }
+        }
+    }
+
     void Context::end_frame() {
-        if (!_render_handler) {
+        bool is_buffered = _frame_ring.slot_count() > 0;
+        if (!_render_handler && !is_buffered) {
             throw exception::NoRenderHandlerException{};
         }
         end_window();
 
+        // Regions left open are dropped
+        _cached_region_depth = 0;
+        _recording_region = nullptr;
+
+        _damage_rects.clear();
         update_window_layers();
         remove_unqueued_windows();
+        // Window chrome is never clipped or transformed, even if the user left something on the stacks
+        _clip_rects.clear();
+        _transforms.clear();
 
-        _render_handler(_free_draw_data, _user_ptr);
-        _free_draw_data.clear();
+        _frame_statistics = FrameStatistics{};
+        if (is_buffered) {
+            begin_frame_snapshot();
+        }
+        auto previous_frame_hash = _frame_hash;
+        _frame_hash = 0;
+        auto free_layer_rect = get_layer_screen_rect(_free_draw_data);
+        render_layer(_free_draw_data, _free_draw_data.content_hash());
+        if (!_free_draw_data.is_unchanged()) {
+            add_damage_rect(_free_layer_rect);
+            add_damage_rect(free_layer_rect);
+        }
+        _free_layer_rect = free_layer_rect;
         render_windows();
+        // Only once the windows are rendered, as the occluded windows' deferred renders index the regions
+        auto unused_from = std::remove_if(_cached_regions.begin(), _cached_regions.end(), [this](const auto& region) {
+            return region.last_used_frame != _frame_counter;
+        });
+        _cached_regions.erase(unused_from, _cached_regions.end());
+        _is_frame_unchanged = _config.change_tracking() && _frame_hash == previous_frame_hash;
+        merge_damage_rects(_damage_rects);
+
+        _frame_statistics.arena_block_allocations = _frame_arena.block_allocation_count();
+        _frame_statistics.cached_windows = _cached_window_count;
+        _frame_statistics.cached_regions = _replayed_region_count;
+        _frame_statistics.occluded_windows = _occluded_window_count;
+        if (_writing_snapshot) {
+            publish_frame_snapshot();
+        }
+    }
+
+    void Context::render_layer(DrawData& draw_data, std::uint64_t previous_hash, bool reorder_commands) {
+        _frame_statistics.emitted_commands += draw_data.commands().size();
+        if (_config.command_culling()) {
+            draw_data.cull_commands(_frame_statistics.culled_commands);
+        }
+        if (reorder_commands) {
+            draw_data.reorder_commands();
+        }
+        _frame_statistics.batched_commands += draw_data.merge_commands();
+
+        // Untracked layers keep a zero hash and are never unchanged, so they are always fully damaged
+        if (_config.change_tracking()) {
+            draw_data.update_content_hash(previous_hash);
+        }
+        ++_frame_statistics.layers;
+        _frame_statistics.unchanged_layers += draw_data.is_unchanged() ? 1 : 0;
+        // The layers' hashes in their order, so that a moved, added or removed layer changes the frame too
+        _frame_hash = (_frame_hash ^ draw_data.content_hash()) * 0x100000001b3u;
+
+        if (_writing_snapshot) {
+            add_snapshot_layer(draw_data);
+        } else {
+            _render_handler(draw_data, _user_ptr);
+        }
+        draw_data.clear();
+    }
+
+    void Context::begin_frame_snapshot() {
+        _writing_slot = _frame_ring.begin_write(_is_replacing_snapshot);
+        _writing_snapshot = &_frame_snapshots[_writing_slot];
+        // The replaced frame was never rendered, so its changes are carried over into this one
+        if (_is_replacing_snapshot) {
+            _replaced_layer_count = _writing_snapshot->_layer_count;
+            _frame_statistics.dropped_frames = _writing_snapshot->_statistics.dropped_frames + 1;
+        } else {
+            _writing_snapshot->_damage_rects.clear();
+            _writing_snapshot->_is_unchanged = true;
+        }
+        _writing_snapshot->_layer_count = 0;
+    }
+
+    void Context::add_snapshot_layer(const DrawData& draw_data) {
+        auto& snapshot = *_writing_snapshot;
+        auto index = snapshot._layer_count++;
+        if (index == snapshot._layers.size()) {
+            snapshot._layers.emplace_back();
+        }
+
+        auto& layer = snapshot._layers[index];
+        bool was_unchanged = !_is_replacing_snapshot || (index < _replaced_layer_count && layer.is_unchanged());
+        layer.assign(draw_data);
+        layer._content_hash = draw_data.content_hash();
+        layer._is_unchanged = draw_data.is_unchanged() && was_unchanged;
+    }
+
+    void Context::publish_frame_snapshot() {
+        auto& snapshot = *_writing_snapshot;
+        snapshot._damage_rects.insert(snapshot._damage_rects.end(), _damage_rects.begin(), _damage_rects.end());
+        merge_damage_rects(snapshot._damage_rects);
+        snapshot._is_unchanged = snapshot._is_unchanged && _is_frame_unchanged;
+        snapshot._statistics = _frame_statistics;
+        snapshot._frame_counter = _frame_counter;
+
+        _frame_ring.publish(_writing_slot);
+        _writing_snapshot = nullptr;
+        _writing_slot = detail::FrameRing::kNoSlot;
+    }
+
+    const FrameSnapshot* Context::acquire_frame() {
+        if (_acquired_slot != detail::FrameRing::kNoSlot) {
+            throw std::logic_error{"invalid state: a frame is already acquired"};
+        }
+        auto slot = _frame_ring.acquire();
+        if (slot == detail::FrameRing::kNoSlot) return nullptr;
+
+        _acquired_slot = slot;
+        return &_frame_snapshots[slot];
+    }
+
+    void Context::release_frame() {
+        if (_acquired_slot == detail::FrameRing::kNoSlot) return;
+
+        _frame_ring.release(_acquired_slot);
+        _acquired_slot = detail::FrameRing::kNoSlot;
+    }
+
+    std::size_t FrameSnapshot::layer_count() const {
+        return _layer_count;
+    }
+
+    const DrawData& FrameSnapshot::layer(std::size_t index) const {
+        return _layers[index];
+    }
+
+    const std::vector<Rectangle>& FrameSnapshot::damage_rects() const {
+        return _damage_rects;
+    }
+
+    bool FrameSnapshot::is_unchanged() const {
+        return _is_unchanged;
+    }
+
+    const FrameStatistics& FrameSnapshot::statistics() const {
+        return _statistics;
+    }
+
+    unsigned FrameSnapshot::frame_counter() const {
+        return _frame_counter;
+    }
+
+    void Context::add_damage_rect(const Rectangle& rect) {
+        if (rect.width > 0.0f && rect.height > 0.0f) {
+            _damage_rects.push_back(rect);
+        }
     }
 
     void Context::update_window_layers() {
@@ -120,6 +330,9 @@ namespace reig {
         auto remove_from = std::remove_if(_windows.begin(), _windows.end(), [](const Window& window) {
             return !window.is_queued();
         });
+        for (auto it = remove_from; it != _windows.end(); ++it) {
+            add_damage_rect(it->rendered_rect());
+        }
         _windows.erase(remove_from, _windows.end());
     }
 
@@ -137,11 +350,11 @@ namespace reig {
         return _dragged_window != window.id();
     }
 
-    void Context::start_window(gsl::czstring title, float default_x, float default_y) {
-        start_window(title, title, default_x, default_y);
+    bool Context::start_window(gsl::czstring title, float default_x, float default_y) {
+        return start_window(title, title, default_x, default_y);
     }
 
-    void Context::start_window(gsl::czstring id, gsl::czstring title, float default_x, float default_y) {
+    bool Context::start_window(gsl::czstring id, gsl::czstring title, float default_x, float default_y) {
         if (!_windows.empty()) end_window();
 
         auto window = std::find_if(_windows.begin(), _windows.end(), [id](const Window& window) {
@@ -151,69 +364,154 @@ namespace reig {
             detail::restart_window(*window, title);
             _queued_window = &*window;
         } else {
-            _windows.emplace(_windows.begin(), id, title, default_x, default_y, 0, 0, _font.height + 8);
+            _windows.emplace(_windows.begin(), id, title, default_x, default_y, 0, 0, _font.height + 8, &_frame_arena);
             _queued_window = &_windows.front();
+            configure_draw_data(_queued_window->draw_data());
+        }
+
+        _queued_window->set_occluded(is_window_occluded(*_queued_window));
+
+        // The content grows right and down from the body's corner, as far as the widgets fit it
+        auto body_rect = get_window_body_rect(*_queued_window);
+        Rectangle content_rect{body_rect.x, body_rect.y, kUnclippedRect.width, kUnclippedRect.height};
+        return get_current_draw_data_buffer() != nullptr && !_queued_window->is_occluded()
+               && is_screen_rect_visible(content_rect);
+    }
+
+    bool Context::are_windows_settled() const {
+        // A click may reorder or collapse the windows and a drag may move them, after the content is emitted
+        return !mouse.left_button.is_clicked() && !_dragged_window;
+    }
+
+    bool Context::is_window_occluded(const Window& window) const {
+        if (!_config.window_occlusion() || !are_windows_settled()) return false;
+        if (_config.fill_mode() != FillMode::kColored
+            || _config.window_bg_color().alpha != 255 || _config.title_bar_bg_color().alpha != 255) {
+            return false;
+        }
+
+        const auto& rect = window.rendered_rect();
+        if (rect.width <= 0.0f || rect.height <= 0.0f) return false;
+
+        // The windows are ordered from the topmost one
+        for (const auto& above : _windows) {
+            if (&above == &window) break;
+            if (is_rect_in_rect(rect, above.rendered_rect())) return true;
+        }
+        return false;
+    }
+
+    bool Context::is_window_covered(const Window& window) const {
+        // Only the body holds the widgets' geometry, the chrome is drawn either way
+        auto body_rect = get_window_body_rect(window);
+        for (const auto& above : _windows) {
+            if (&above == &window) break;
+            if (is_rect_in_rect(body_rect, get_window_full_rect(above))) return true;
         }
+        return false;
     }
 
     void Context::render_windows() {
         for(auto it = _windows.rbegin(); it != _windows.rend(); ++it) {
             auto& current_window = *it;
 
-            auto current_widget_data = move(current_window.draw_data());
-            current_window.draw_data().clear();
+            // The guess from the start of the window is checked against where the windows ended up.
+            // If the cover moved away, the widgets may have skipped their content, so it's drawn in full next frame
+            bool was_incomplete = current_window.is_incomplete();
+            current_window.set_incomplete(false);
+            if (current_window.is_occluded()) {
+                if (is_window_covered(current_window)) {
+                    ++_occluded_window_count;
+                } else {
+                    flush_deferred_draw_calls(current_window);
+                    current_window.set_incomplete(true);
+                }
+            }
 
-            auto header_rect = get_window_header_rect(current_window);
-            auto minimize_rect = get_window_minimize_rect(current_window);
-            auto title_rect = decrease_rect(header_rect, 4);
             auto body_rect = get_window_body_rect(current_window);
 
-            if (_config.fill_mode() == FillMode::kTextured) {
-                render_rectangle(current_window.draw_data(), header_rect, _config.title_bar_bg_texture_id());
+            // The chrome only changes with the window's state, otherwise it's copied from the last frame
+            bool is_focused = it == _windows.rend() - 1;
+            auto chrome_fingerprint = get_chrome_fingerprint(current_window, is_focused);
+            if (chrome_fingerprint == current_window.chrome_fingerprint()) {
+                _chrome_draw_data.assign(current_window.cached_chrome());
             } else {
-                auto frame_color = it != _windows.rend() - 1
-                                   ? colors::dim_color_by(_config.title_bar_bg_color(), 127)
-                                   : _config.title_bar_bg_color();
-                render_rectangle(current_window.draw_data(), header_rect, frame_color);
+                render_window_chrome(current_window, is_focused);
+                current_window.cached_chrome().assign(_chrome_draw_data);
+                current_window.set_chrome_fingerprint(chrome_fingerprint);
             }
-            render_rectangle(current_window.draw_data(), minimize_rect, colors::kLightGrey);
-            render_rectangle(current_window.draw_data(), decrease_rect(minimize_rect, 2), colors::kBlack);
-            if (current_window.is_collapsed()) {
-                minimize_rect = decrease_rect(minimize_rect, 8);
-                render_rectangle(current_window.draw_data(), minimize_rect, colors::kLightGrey);
-            } else {
-                minimize_rect = decrease_rect(minimize_rect, 12);
-                minimize_rect.x = minimize_rect.x - 2;
-                minimize_rect.y = minimize_rect.y - 2;
-                render_rectangle(current_window.draw_data(), minimize_rect, colors::kLightGrey);
-                minimize_rect.x += 4;
-                minimize_rect.y += 4;
-                render_rectangle(current_window.draw_data(), minimize_rect, colors::kLightGrey);
+
+            // Placed at the window's final position, it may have been dragged after its widgets were recorded
+            current_window.draw_data().translate_commands({current_window.x(), current_window.y()});
+            current_window.draw_data().clip_commands(body_rect);
+            render_layer(_chrome_draw_data, current_window.chrome_hash());
+            current_window.set_chrome_hash(_chrome_draw_data.content_hash());
+            render_layer(current_window.draw_data(), current_window.draw_data().content_hash(),
+                         _config.command_reordering());
+
+            auto layer = static_cast<std::size_t>(std::distance(_windows.begin(), it.base()) - 1);
+            auto full_rect = get_window_full_rect(current_window);
+            if (!_chrome_draw_data.is_unchanged() || !current_window.draw_data().is_unchanged()
+                || layer != current_window.rendered_layer() || current_window.is_incomplete() || was_incomplete) {
+                add_damage_rect(current_window.rendered_rect());
+                add_damage_rect(full_rect);
             }
-            render_text(current_window.draw_data(), current_window.title(), title_rect);
-            if (_config.fill_mode() == FillMode::kTextured) {
-                render_rectangle(current_window.draw_data(), body_rect, _config.window_bg_texture_id());
-            } else {
-                auto frame_color = it != _windows.rend() - 1
-                                   ? colors::dim_color_by(_config.title_bar_bg_color(), 127)
-                                   : _config.title_bar_bg_color();
+            current_window.set_rendered_rect(full_rect);
+            current_window.set_rendered_layer(layer);
+        }
+    }
 
-                int thickness = 1;
-                render_rectangle(current_window.draw_data(), decrease_rect(body_rect, thickness),
-                                 _config.window_bg_color());
+    void Context::render_window_chrome(const Window& window, bool is_focused) {
+        auto header_rect = get_window_header_rect(window);
+        auto minimize_rect = get_window_minimize_rect(window);
+        auto title_rect = decrease_rect(header_rect, 4);
+        auto body_rect = get_window_body_rect(window);
 
-                auto frame = get_rect_frame(body_rect, thickness);
-                for (const auto& frame_rect : frame) {
-                    render_rectangle(current_window.draw_data(), frame_rect, frame_color);
-                }
-            }
+        if (_config.fill_mode() == FillMode::kTextured) {
+            render_rectangle(_chrome_draw_data, header_rect, _config.title_bar_bg_texture_id());
+        } else {
+            auto frame_color = is_focused
+                               ? _config.title_bar_bg_color()
+                               : colors::dim_color_by(_config.title_bar_bg_color(), 127);
+            render_rectangle(_chrome_draw_data, header_rect, frame_color);
+        }
+        render_bordered_rectangle(_chrome_draw_data, minimize_rect, colors::kBlack, colors::kLightGrey, 1.0f, true);
+        if (window.is_collapsed()) {
+            minimize_rect = decrease_rect(minimize_rect, 8);
+            render_rectangle(_chrome_draw_data, minimize_rect, colors::kLightGrey);
+        } else {
+            minimize_rect = decrease_rect(minimize_rect, 12);
+            minimize_rect.x = minimize_rect.x - 2;
+            minimize_rect.y = minimize_rect.y - 2;
+            render_rectangle(_chrome_draw_data, minimize_rect, colors::kLightGrey);
+            minimize_rect.x += 4;
+            minimize_rect.y += 4;
+            render_rectangle(_chrome_draw_data, minimize_rect, colors::kLightGrey);
+        }
+        render_text(_chrome_draw_data, window.title(), title_rect);
+        if (_config.fill_mode() == FillMode::kTextured) {
+            render_rectangle(_chrome_draw_data, body_rect, _config.window_bg_texture_id());
+        } else {
+            auto frame_color = is_focused
+                               ? _config.title_bar_bg_color()
+                               : colors::dim_color_by(_config.title_bar_bg_color(), 127);
+            // The frame only surrounds the body's fill, a translucent body shows what's behind the window
+            render_bordered_rectangle(_chrome_draw_data, body_rect, _config.window_bg_color(), frame_color,
+                                      1.0f, false);
+        }
+    }
+
+    std::uint64_t Context::get_chrome_fingerprint(const Window& window, bool is_focused) const {
+        float const geometry[] = {window.x(), window.y(), window.width(), window.height(), window.title_bar_height()};
+        uint8_t const states[] = {window.is_collapsed(), is_focused};
 
-            _render_handler(current_window.draw_data(), _user_ptr);
-            _render_handler(current_widget_data, _user_ptr);
-            // current_widget_data is likely to have larger capacity, so place it back
-            current_widget_data.clear();
-            current_window.draw_data() = move(current_widget_data);
+        auto fingerprint = detail::hash_bytes(&_cache_generation, sizeof(_cache_generation));
+        fingerprint = detail::hash_bytes(geometry, sizeof(geometry), fingerprint);
+        fingerprint = detail::hash_bytes(states, sizeof(states), fingerprint);
+        if (window.title()) {
+            fingerprint = detail::hash_bytes(window.title(), std::strlen(window.title()), fingerprint);
         }
+        return fingerprint;
     }
 
     void Context::end_window() {
@@ -221,6 +519,13 @@ namespace reig {
 
         if (_queued_window != nullptr) {
             handle_window_input(*_queued_window);
+            _queued_window->cached_text_ends().resize(_recorded_text_count);
+            _recorded_text_count = 0;
+            if (_queued_window->is_occluded()) {
+                defer_draw_calls(*_queued_window);
+            } else if (_config.window_caching()) {
+                flush_draw_calls(*_queued_window);
+            }
             _queued_window = nullptr;
         }
     }
@@ -279,11 +584,166 @@ namespace reig {
 
     void Context::fit_rect_in_window(Rectangle& rect) {
         if (_queued_window != nullptr) {
+            if (_recording_region) {
+                _recording_region->fitted_rects.push_back(rect);
+            }
             detail::fit_rect_in_window(rect, *_queued_window);
         }
+        if (_recording_region) {
+            auto origin = get_draw_origin();
+            _recording_region->hit_rects.push_back(translate_rect(rect, {-origin.x, -origin.y}));
+        }
+    }
+
+    bool Context::is_rect_visible(const Rectangle& rect) const {
+        if (_queued_window && (_queued_window->is_collapsed() || _queued_window->is_occluded())) return false;
+
+        return is_screen_rect_visible(to_screen_space(rect));
+    }
+
+    bool Context::is_screen_rect_visible(const Rectangle& rect) const {
+        if (!is_rect_overlapping(rect, get_clip_rect())) return false;
+        if (_recording_region || (_queued_window && !are_windows_settled())) return true;
+        if (!is_rect_overlapping(rect, _viewport_rect)) return false;
+
+        // Only the body's top and left edges are known, until all of the window's widgets are fitted
+        if (_queued_window) {
+            auto body_rect = get_window_body_rect(*_queued_window);
+            return get_x2(rect) > body_rect.x && get_y2(rect) > body_rect.y;
+        }
+        return true;
+    }
+
+    bool Context::begin_cached_region(gsl::czstring id, std::uint64_t version) {
+        if (_cached_region_depth++ > 0) return true;
+
+        // Nothing is drawn in a collapsed window, the widgets run only to fit their rects
+        auto* buffer = get_current_draw_data_buffer();
+        if (buffer == nullptr) return true;
+
+        auto region = std::find_if(_cached_regions.begin(), _cached_regions.end(), [id](const auto& cached) {
+            return cached.id == id;
+        });
+        if (region == _cached_regions.end()) {
+            region = _cached_regions.emplace(_cached_regions.end(), id);
+        }
+        region->last_used_frame = _frame_counter;
+
+        if (region->is_recorded && region->version == version && region->cache_generation == _cache_generation
+            && !is_cached_region_hit(*region)) {
+            if (_queued_window) {
+                for (auto fitted_rect : region->fitted_rects) {
+                    detail::fit_rect_in_window(fitted_rect, *_queued_window);
+                }
+            }
+            add_cached_region(static_cast<std::size_t>(region - _cached_regions.begin()));
+            ++_replayed_region_count;
+            return false;
+        }
+        // The widgets of a covered window skip their content, which mustn't be kept as the region's
+        if (_queued_window && _queued_window->is_occluded()) return true;
+
+        region->version = version;
+        region->cache_generation = _cache_generation;
+        region->is_recorded = false;
+        region->draw_data.clear();
+        configure_draw_data(region->draw_data);
+        region->fitted_rects.clear();
+        region->hit_rects.clear();
+        _recording_region = &*region;
+        return true;
+    }
+
+    void Context::end_cached_region() {
+        if (_cached_region_depth == 0 || --_cached_region_depth > 0) return;
+        if (!_recording_region) return;
+
+        auto* region = _recording_region;
+        _recording_region = nullptr;
+        region->is_recorded = true;
+        add_cached_region(static_cast<std::size_t>(region - _cached_regions.data()));
+    }
+
+    void Context::add_cached_region(std::size_t region_index) {
+        if (is_recording_draw_calls()) {
+            record_draw_call(detail::DrawCallType::kCachedRegion, {}).region_index = region_index;
+            return;
+        }
+        auto* buffer = get_current_draw_data_buffer();
+        if (buffer != nullptr) {
+            buffer->append(_cached_regions[region_index].draw_data);
+        }
+    }
+
+    bool Context::is_cached_region_hit(const detail::CachedRegion& region) const {
+        auto origin = get_draw_origin();
+        return std::any_of(region.hit_rects.begin(), region.hit_rects.end(), [this, &origin](const Rectangle& rect) {
+            auto hit_rect = translate_rect(rect, origin);
+            return mouse.is_hovering_over_rect(hit_rect) || mouse.left_button.clicked_in_rect(hit_rect);
+        });
+    }
+
+    void Context::push_clip_rect(const Rectangle& rect) {
+        _clip_rects.push_back(get_overlapping_rect(get_clip_rect(), to_screen_space(rect)));
+    }
+
+    void Context::pop_clip_rect() {
+        if (!_clip_rects.empty()) {
+            _clip_rects.pop_back();
+        }
+    }
+
+    const Rectangle& Context::get_clip_rect() const {
+        return _clip_rects.empty() ? kUnclippedRect : _clip_rects.back();
+    }
+
+    void Context::push_transform(const Point& translation, float scale) {
+        if (!(scale > 0.0f)) throw exception::InvalidTransformException{scale};
+
+        _transforms.push_back(combine_transforms(get_transform(), {translation, scale}));
+    }
+
+    void Context::pop_transform() {
+        if (!_transforms.empty()) {
+            _transforms.pop_back();
+        }
+    }
+
+    const Transform& Context::get_transform() const {
+        static const Transform identity;
+        return _transforms.empty() ? identity : _transforms.back();
+    }
+
+    Rectangle Context::to_screen_space(const Rectangle& rect) const {
+        auto origin = get_draw_origin();
+        auto local_rect = translate_rect(rect, {-origin.x, -origin.y});
+        return translate_rect(transform_rect(get_transform(), local_rect), origin);
+    }
+
+    Point Context::to_widget_space(const Point& point) const {
+        auto origin = get_draw_origin();
+        auto local_point = inverse_transform_point(get_transform(), {point.x - origin.x, point.y - origin.y});
+        return {local_point.x + origin.x, local_point.y + origin.y};
+    }
+
+    void Context::start_command(DrawData& draw_data, int texture_id, const Rectangle& clip_rect) {
+        // Geometry is recorded relative to the origin, so the transform is too
+        auto origin = get_draw_origin();
+        auto local_clip_rect = translate_rect(clip_rect, {-origin.x, -origin.y});
+        draw_data.start_command(texture_id, inverse_transform_rect(get_transform(), local_clip_rect), get_transform());
+    }
+
+    Point Context::get_draw_origin() const {
+        if (_queued_window) {
+            return {_queued_window->x(), _queued_window->y()};
+        }
+        return {};
     }
 
     DrawData* Context::get_current_draw_data_buffer() {
+        if (_recording_region) {
+            return &_recording_region->draw_data;
+        }
         if (_queued_window) {
             return !_queued_window->is_collapsed() ? &_queued_window->draw_data() : nullptr;
         } else {
@@ -291,11 +751,159 @@ namespace reig {
         }
     }
 
+    void Context::configure_draw_data(DrawData& draw_data) {
+        draw_data.set_geometry_output(_config.geometry_output());
+        draw_data.set_vertex_streams(_config.vertex_streams());
+    }
+
+    /**
+     * @brief Moves a clip rectangle by the offset, keeping the unclipped one exact instead of rounding it
+     */
+    Rectangle translate_clip_rect(const Rectangle& clip_rect, const Point& offset) {
+        return is_same_rect(clip_rect, kUnclippedRect) ? clip_rect : translate_rect(clip_rect, offset);
+    }
+
+    bool Context::is_recording_draw_calls() const {
+        return _queued_window != nullptr && (_config.window_caching() || _queued_window->is_occluded())
+               && !_is_replaying_draw_calls && _recording_region == nullptr;
+    }
+
+    detail::DrawCall& Context::record_draw_call(detail::DrawCallType type, const Rectangle& rect) {
+        auto origin = get_draw_origin();
+        detail::DrawCall call;
+        call.type = type;
+        call.rect = translate_rect(rect, {-origin.x, -origin.y});
+        call.clip_rect = translate_clip_rect(get_clip_rect(), {-origin.x, -origin.y});
+        call.transform = get_transform();
+        _draw_calls.push_back(call);
+        return _draw_calls.back();
+    }
+
+    void Context::flush_draw_calls(Window& window) {
+        std::size_t const hashed_size = offsetof(detail::DrawCall, alignment) + sizeof(text::Alignment);
+        static_assert(hashed_size == sizeof(detail::DrawCallType) + sizeof(int) + sizeof(Rectangle) * 2
+                                     + sizeof(Transform) + sizeof(std::array<Color, 4>) + sizeof(float)
+                                     + sizeof(text::Alignment),
+                      "The hashed part of DrawCall is expected to have no padding");
+
+        auto fingerprint = detail::hash_bytes(&_cache_generation, sizeof(_cache_generation));
+        for (const auto& call : _draw_calls) {
+            fingerprint = detail::hash_bytes(&call, hashed_size, fingerprint);
+            if (call.text) {
+                fingerprint = detail::hash_bytes(call.text, std::strlen(call.text), fingerprint);
+            }
+            fingerprint = detail::hash_bytes(call.points, call.point_count * sizeof(Point), fingerprint);
+            if (call.type == detail::DrawCallType::kCachedRegion) {
+                const auto& region = _cached_regions[call.region_index];
+                fingerprint = detail::hash_bytes(&region.id, sizeof(region.id), fingerprint);
+                fingerprint = detail::hash_bytes(&region.version, sizeof(region.version), fingerprint);
+            }
+        }
+
+        // The geometry is relative to the window's origin, so it can be reused even if the window has moved
+        if (fingerprint == window.fingerprint()) {
+            window.draw_data().assign(window.cached_draw_data());
+            ++_cached_window_count;
+        } else {
+            replay_draw_calls();
+            window.cached_draw_data().assign(window.draw_data());
+            window.set_fingerprint(fingerprint);
+        }
+        _draw_calls.clear();
+    }
+
+    void Context::replay_draw_calls() {
+        auto origin = get_draw_origin();
+        _is_replaying_draw_calls = true;
+        for (const auto& call : _draw_calls) {
+            auto rect = translate_rect(call.rect, origin);
+            // The recorded state replaces whatever is on the stacks, for the call's duration
+            _clip_rects.push_back(translate_clip_rect(call.clip_rect, origin));
+            _transforms.push_back(call.transform);
+            switch (call.type) {
+                case detail::DrawCallType::kText:
+                    render_text(call.text, rect, call.alignment, call.value);
+                    break;
+                case detail::DrawCallType::kRectangle:
+                    render_rectangle(rect, call.colors[0]);
+                    break;
+                case detail::DrawCallType::kTexturedRectangle:
+                    render_rectangle(rect, call.texture_id);
+                    break;
+                case detail::DrawCallType::kBorderedRectangle:
+                    render_bordered_rectangle(rect, call.colors[0], call.colors[1], call.value);
+                    break;
+                case detail::DrawCallType::kGradientRectangle:
+                    render_gradient_rectangle(rect, call.colors[0], call.colors[1], call.colors[2], call.colors[3]);
+                    break;
+                case detail::DrawCallType::kRoundedRectangle:
+                    render_rounded_rectangle(rect, call.value, call.colors[0]);
+                    break;
+                case detail::DrawCallType::kCircle:
+                    render_circle({rect.x, rect.y}, call.value, call.colors[0]);
+                    break;
+                case detail::DrawCallType::kPolyline: {
+                    std::pmr::vector<Point> points{&_frame_arena};
+                    points.reserve(call.point_count);
+                    for (std::size_t i = 0; i < call.point_count; ++i) {
+                        points.push_back({call.points[i].x + origin.x, call.points[i].y + origin.y});
+                    }
+                    render_polyline(points.data(), points.size(), call.value, call.colors[0]);
+                    break;
+                }
+                case detail::DrawCallType::kCachedRegion:
+                    add_cached_region(call.region_index);
+                    break;
+            }
+            _clip_rects.pop_back();
+            _transforms.pop_back();
+        }
+        _is_replaying_draw_calls = false;
+    }
+
+    void Context::defer_draw_calls(Window& window) {
+        window.set_deferred_calls(_deferred_draw_calls.size(), _draw_calls.size());
+        _deferred_draw_calls.insert(_deferred_draw_calls.end(), _draw_calls.begin(), _draw_calls.end());
+        _draw_calls.clear();
+    }
+
+    void Context::flush_deferred_draw_calls(Window& window) {
+        auto first_call = _deferred_draw_calls.begin() + static_cast<std::ptrdiff_t>(window.first_deferred_call());
+        _draw_calls.assign(first_call, first_call + static_cast<std::ptrdiff_t>(window.deferred_call_count()));
+        window.set_occluded(false);
+
+        // Emitted as if the window was just ending, its renders are relative to its origin and clip rectangle
+        _queued_window = &window;
+        if (_config.window_caching()) {
+            flush_draw_calls(window);
+        } else {
+            replay_draw_calls();
+            _draw_calls.clear();
+        }
+        _queued_window = nullptr;
+    }
+
     void Context::start_frame() {
+        auto reset_draw_data = [this](DrawData& draw_data) {
+            draw_data.release();
+            configure_draw_data(draw_data);
+        };
+        reset_draw_data(_free_draw_data);
+        reset_draw_data(_chrome_draw_data);
+        for (auto& window : _windows) {
+            reset_draw_data(window.draw_data());
+        }
+        _draw_calls = std::pmr::vector<detail::DrawCall>{&_frame_arena};
+        _deferred_draw_calls = std::pmr::vector<detail::DrawCall>{&_frame_arena};
+        _frame_arena.reset();
+
         mouse.left_button._is_clicked = false;
         mouse._scrolled = 0.f;
 
         keyboard.reset();
+        _cached_window_count = 0;
+        _replayed_region_count = 0;
+        _occluded_window_count = 0;
 
         for (auto& window : _windows) {
             window.set_queued(false);
@@ -308,6 +916,30 @@ namespace reig {
         return _frame_counter;
     }
 
+    const FrameStatistics& Context::get_frame_statistics() const {
+        return _frame_statistics;
+    }
+
+    const std::vector<Rectangle>& Context::get_damage_rects() const {
+        return _damage_rects;
+    }
+
+    bool Context::is_frame_unchanged() const {
+        return _is_frame_unchanged;
+    }
+
+    void Context::set_viewport_size(float width, float height) {
+        _viewport_rect = {0.0f, 0.0f, width, height};
+    }
+
+    const Rectangle& Context::get_viewport_rect() const {
+        return _viewport_rect;
+    }
+
+    std::pmr::memory_resource* Context::get_frame_memory_resource() {
+        return &_frame_arena;
+    }
+
     bool has_alignment(text::Alignment container, text::Alignment alignment) {
         auto container_as_uint = static_cast<unsigned>(container);
         auto alignment_as_uint = static_cast<unsigned>(alignment);
@@ -333,24 +965,47 @@ namespace reig {
 
     float Context::render_text(gsl::czstring text, const Rectangle rect, text::Alignment alignment, float scale) {
         auto* buffer = get_current_draw_data_buffer();
-        if (buffer != nullptr) {
+        if (buffer == nullptr) return rect.x;
+
+        if (!is_recording_draw_calls()) {
             return render_text(*buffer, text, rect, alignment, scale);
         }
-        return rect.x;
-    }
-
-    float Context::render_text(DrawData& draw_data, gsl::czstring text, Rectangle rect, text::Alignment alignment,
-                               float scale) {
         if (_font.baked_chars.empty() || !text) return rect.x;
 
+        auto size = std::strlen(text) + 1;
+        auto* text_copy = static_cast<char*>(_frame_arena.allocate(size, alignof(char)));
+        std::memcpy(text_copy, text, size);
+        auto& call = record_draw_call(detail::DrawCallType::kText, rect);
+        call.text = text_copy;
+        call.alignment = alignment;
+        call.value = scale;
+
+        // The widgets may need the text's end, e.g. for a caret. It's only laid out if it isn't the same text,
+        // in the same rect, as at this place of the window in the last frame
+        float const layout[] = {rect.x, rect.width, scale};
+        auto key = detail::hash_bytes(&_cache_generation, sizeof(_cache_generation));
+        key = detail::hash_bytes(layout, sizeof(layout), key);
+        key = detail::hash_bytes(text, size, key);
+
+        auto& text_ends = _queued_window->cached_text_ends();
+        auto index = _recorded_text_count++;
+        if (index == text_ends.size()) {
+            text_ends.emplace_back();
+        } else if (text_ends[index].key == key) {
+            return text_ends[index].end_x;
+        }
+
+        std::pmr::vector<stbtt_aligned_quad> quads{&_frame_arena};
+        text_ends[index] = {key, layout_text(text, rect, scale, quads)};
+        return text_ends[index].end_x;
+    }
+
+    float Context::layout_text(gsl::czstring text, const Rectangle& rect, float scale,
+                               std::pmr::vector<stbtt_aligned_quad>& quads) {
         float x = rect.x;
         float y = rect.y + rect.height;
 
-        float min_y = y;
-        float max_y = y;
-
-        vector<stbtt_aligned_quad> quads;
-        quads.reserve(20);
+        quads.reserve(std::strlen(text));
 
         auto from_char = int{' '};
         int to_char = from_char + 95;
@@ -369,14 +1024,24 @@ namespace reig {
             if (quad.x0 > get_x2(rect)) {
                 break;
             }
-            quad.x1 = math::min(quad.x1, get_x2(rect));
-//            quad.y0 = internal::max(quad.y0, rect.y);
-//            quad.y1 = internal::min(quad.y1, get_y2(rect));
 
+            quads.push_back(quad);
+        }
+        return x;
+    }
+
+    float Context::render_text(DrawData& draw_data, gsl::czstring text, Rectangle rect, text::Alignment alignment,
+                               float scale) {
+        if (_font.baked_chars.empty() || !text) return rect.x;
+
+        std::pmr::vector<stbtt_aligned_quad> quads{&_frame_arena};
+        float x = layout_text(text, rect, scale, quads);
+
+        float min_y = rect.y + rect.height;
+        float max_y = min_y;
+        for (const auto& quad : quads) {
             min_y = math::min(min_y, quad.y0);
             max_y = math::max(max_y, quad.y1);
-
-            quads.push_back(quad);
         }
 
         float text_height = max_y - min_y;
@@ -394,67 +1059,204 @@ namespace reig {
                 has_alignment(alignment, text::Alignment::kBottom) ? 0.0f :
                 (rect.height - text_height) * -0.5f;
 
-        render_text_quads(draw_data, quads, horizontal_alignment, vertical_alignment, _font.texture_id);
+        // Text overhanging the sides of its box is cut by the scissor, instead of the glyphs being squashed.
+        // Fitting text keeps the current clip rectangle, so it can still be batched with its neighbours
+        auto clip_rect = get_clip_rect();
+        if (!quads.empty() && (quads.front().x0 + horizontal_alignment < rect.x
+                               || quads.back().x1 + horizontal_alignment > get_x2(rect))) {
+            Rectangle text_clip_rect{rect.x, kUnclippedRect.y, rect.width, kUnclippedRect.height};
+            clip_rect = get_overlapping_rect(clip_rect, to_screen_space(text_clip_rect));
+        }
+        render_text_quads(draw_data, quads, horizontal_alignment, vertical_alignment, _font.texture_id, clip_rect);
 
         return x;
     }
 
     void Context::render_rectangle(const Rectangle& rect, const Color& color) {
         auto* buffer = get_current_draw_data_buffer();
-        if (buffer != nullptr) {
+        if (buffer == nullptr) return;
+
+        if (is_recording_draw_calls()) {
+            record_draw_call(detail::DrawCallType::kRectangle, rect).colors[0] = color;
+        } else {
             render_rectangle(*buffer, rect, color);
         }
     }
 
     void Context::render_rectangle(const Rectangle& rect, int texture_id) {
         auto* buffer = get_current_draw_data_buffer();
-        if (buffer != nullptr) {
+        if (buffer == nullptr) return;
+
+        if (is_recording_draw_calls()) {
+            record_draw_call(detail::DrawCallType::kTexturedRectangle, rect).texture_id = texture_id;
+        } else {
             render_rectangle(*buffer, rect, texture_id);
         }
     }
 
+    void Context::render_bordered_rectangle(const Rectangle& rect, const Color& fill_color, const Color& border_color,
+                                            float border_thickness) {
+        auto* buffer = get_current_draw_data_buffer();
+        if (buffer == nullptr) return;
+
+        if (is_recording_draw_calls()) {
+            auto& call = record_draw_call(detail::DrawCallType::kBorderedRectangle, rect);
+            call.colors = {fill_color, border_color};
+            call.value = border_thickness;
+        } else {
+            render_bordered_rectangle(*buffer, rect, fill_color, border_color, border_thickness, true);
+        }
+    }
+
+    void Context::render_gradient_rectangle(const Rectangle& rect, const Color& top_left, const Color& top_right,
+                                            const Color& bottom_right, const Color& bottom_left) {
+        auto* buffer = get_current_draw_data_buffer();
+        if (buffer == nullptr) return;
+
+        if (is_recording_draw_calls()) {
+            record_draw_call(detail::DrawCallType::kGradientRectangle, rect).colors = {
+                    top_left, top_right, bottom_right, bottom_left
+            };
+            return;
+        }
+
+        const auto& clip_rect = get_clip_rect();
+        if (!is_rect_overlapping(to_screen_space(rect), clip_rect)) return;
+
+        auto origin = get_draw_origin();
+        start_command(*buffer, 0, clip_rect);
+        buffer->add_gradient_rect(translate_rect(rect, {-origin.x, -origin.y}),
+                                  top_left, top_right, bottom_right, bottom_left);
+    }
+
+    void Context::render_rounded_rectangle(const Rectangle& rect, float radius, const Color& color) {
+        auto* buffer = get_current_draw_data_buffer();
+        if (buffer == nullptr) return;
+
+        if (is_recording_draw_calls()) {
+            auto& call = record_draw_call(detail::DrawCallType::kRoundedRectangle, rect);
+            call.colors[0] = color;
+            call.value = radius;
+            return;
+        }
+
+        const auto& clip_rect = get_clip_rect();
+        if (!is_rect_overlapping(to_screen_space(rect), clip_rect)) return;
+
+        auto segment_count = detail::get_circle_segment_count(radius * get_transform().scale);
+        auto origin = get_draw_origin();
+        start_command(*buffer, 0, clip_rect);
+        buffer->add_rounded_rect(translate_rect(rect, {-origin.x, -origin.y}), radius,
+                                 detail::get_unit_circle(segment_count), color);
+    }
+
+    void Context::render_circle(const Point& center, float radius, const Color& color) {
+        auto* buffer = get_current_draw_data_buffer();
+        if (buffer == nullptr) return;
+
+        if (is_recording_draw_calls()) {
+            auto& call = record_draw_call(detail::DrawCallType::kCircle, {center.x, center.y, 0.0f, 0.0f});
+            call.colors[0] = color;
+            call.value = radius;
+            return;
+        }
+
+        Rectangle bounds{center.x - radius, center.y - radius, radius * 2, radius * 2};
+        const auto& clip_rect = get_clip_rect();
+        if (!is_rect_overlapping(to_screen_space(bounds), clip_rect)) return;
+
+        auto segment_count = detail::get_circle_segment_count(radius * get_transform().scale);
+        auto origin = get_draw_origin();
+        start_command(*buffer, 0, clip_rect);
+        buffer->add_circle({center.x - origin.x, center.y - origin.y}, radius,
+                           detail::get_unit_circle(segment_count), color);
+    }
+
+    void Context::render_polyline(const Point* points, std::size_t point_count, float thickness, const Color& color) {
+        auto* buffer = get_current_draw_data_buffer();
+        if (buffer == nullptr || point_count < 2) return;
+
+        if (is_recording_draw_calls()) {
+            auto origin = get_draw_origin();
+            auto* points_copy = static_cast<Point*>(_frame_arena.allocate(sizeof(Point) * point_count, alignof(Point)));
+            for (std::size_t i = 0; i < point_count; ++i) {
+                points_copy[i] = {points[i].x - origin.x, points[i].y - origin.y};
+            }
+            auto& call = record_draw_call(detail::DrawCallType::kPolyline, {});
+            call.colors[0] = color;
+            call.value = thickness;
+            call.points = points_copy;
+            call.point_count = point_count;
+            return;
+        }
+
+        Point min = points[0];
+        Point max = points[0];
+        for (std::size_t i = 1; i < point_count; ++i) {
+            min = {math::min(min.x, points[i].x), math::min(min.y, points[i].y)};
+            max = {math::max(max.x, points[i].x), math::max(max.y, points[i].y)};
+        }
+        // The fringe is a pixel wide on the screen, whatever the scale
+        auto fringe_width = 1.0f / get_transform().scale;
+        auto half_width = thickness * 0.5f + fringe_width;
+        Rectangle bounds{min.x - half_width, min.y - half_width,
+                         max.x - min.x + half_width * 2, max.y - min.y + half_width * 2};
+        const auto& clip_rect = get_clip_rect();
+        if (!is_rect_overlapping(to_screen_space(bounds), clip_rect)) return;
+
+        auto origin = get_draw_origin();
+        start_command(*buffer, 0, clip_rect);
+        buffer->add_polyline(points, point_count, {-origin.x, -origin.y}, thickness, fringe_width, color);
+    }
+
+    void Context::render_bordered_rectangle(DrawData& draw_data, const Rectangle& rect, const Color& fill_color,
+                                            const Color& border_color, float border_thickness,
+                                            bool is_border_under_fill) {
+        const auto& clip_rect = get_clip_rect();
+        if (!is_rect_overlapping(to_screen_space(rect), clip_rect)) return;
+
+        auto origin = get_draw_origin();
+        start_command(draw_data, 0, clip_rect);
+        draw_data.add_bordered_rect(translate_rect(rect, {-origin.x, -origin.y}), border_thickness,
+                                    fill_color, border_color, is_border_under_fill);
+    }
+
     void Context::render_rectangle(DrawData& draw_data, const Rectangle& rect, const Color& color) {
-        vector<Vertex> vertices{
-                {{rect.x,       rect.y},       {}, color},
-                {{get_x2(rect), rect.y},       {}, color},
-                {{get_x2(rect), get_y2(rect)}, {}, color},
-                {{rect.x,       get_y2(rect)}, {}, color}
-        };
-        vector<int> indices{0, 1, 2, 2, 3, 0};
+        const auto& clip_rect = get_clip_rect();
+        if (!is_rect_overlapping(to_screen_space(rect), clip_rect)) return;
 
-        Figure fig;
-        fig.form(vertices, indices);
-        draw_data.push_back(fig);
+        auto origin = get_draw_origin();
+        start_command(draw_data, 0, clip_rect);
+        draw_data.add_rect(translate_rect(rect, {-origin.x, -origin.y}), {}, color);
     }
 
     void Context::render_rectangle(DrawData& draw_data, const Rectangle& rect, int texture_id) {
-        vector<Vertex> vertices{
-                {{rect.x,       rect.y},       {0.f, 0.f}, {}},
-                {{get_x2(rect), rect.y},       {1.f, 0.f}, {}},
-                {{get_x2(rect), get_y2(rect)}, {1.f, 1.f}, {}},
-                {{rect.x,       get_y2(rect)}, {0.f, 1.f}, {}}
-        };
-        vector<int> indices{0, 1, 2, 2, 3, 0};
+        const auto& clip_rect = get_clip_rect();
+        if (!is_rect_overlapping(to_screen_space(rect), clip_rect)) return;
 
-        Figure fig;
-        fig.form(vertices, indices, texture_id);
-        draw_data.push_back(fig);
+        auto origin = get_draw_origin();
+        start_command(draw_data, texture_id, clip_rect);
+        draw_data.add_rect(translate_rect(rect, {-origin.x, -origin.y}), {0.f, 0.f, 1.f, 1.f}, {});
     }
 
-    void Context::render_text_quads(DrawData& draw_data, const std::vector<stbtt_aligned_quad>& quads,
-                                    float horizontal_alignment, float vertical_alignment, int font_texture_id) {
+    void Context::render_text_quads(DrawData& draw_data, const std::pmr::vector<stbtt_aligned_quad>& quads,
+                                    float horizontal_alignment, float vertical_alignment, int font_texture_id,
+                                    const Rectangle& clip_rect) {
+        auto origin = get_draw_origin();
+        Point to_origin{-origin.x, -origin.y};
+
+        // The whole run shares the font texture, so it goes into a single command,
+        // started with the first visible glyph
+        bool is_command_started = false;
         for (auto& q : quads) {
-            vector<Vertex> vertices{
-                    {{q.x0 + horizontal_alignment, q.y0 + vertical_alignment}, {q.s0, q.t0}, {}},
-                    {{q.x1 + horizontal_alignment, q.y0 + vertical_alignment}, {q.s1, q.t0}, {}},
-                    {{q.x1 + horizontal_alignment, q.y1 + vertical_alignment}, {q.s1, q.t1}, {}},
-                    {{q.x0 + horizontal_alignment, q.y1 + vertical_alignment}, {q.s0, q.t1}, {}}
-            };
-            vector<int> indices{0, 1, 2, 2, 3, 0};
+            Rectangle glyph_rect{q.x0 + horizontal_alignment, q.y0 + vertical_alignment, q.x1 - q.x0, q.y1 - q.y0};
+            if (!is_rect_overlapping(to_screen_space(glyph_rect), clip_rect)) continue;
 
-            Figure fig;
-            fig.form(vertices, indices, font_texture_id);
-            draw_data.push_back(fig);
+            if (!is_command_started) {
+                start_command(draw_data, font_texture_id, clip_rect);
+                is_command_started = true;
+            }
+            draw_data.add_rect(translate_rect(glyph_rect, to_origin), {q.s0, q.t0, q.s1 - q.s0, q.t1 - q.t0}, {});
         }
     }
 }
\ No newline at end of file
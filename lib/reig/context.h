@@ -3,16 +3,22 @@
 
 #include "context_fwd.h"
 #include "window.h"
+#include "draw_list.h"
 #include "mouse.h"
 #include "keyboard.h"
 #include "text.h"
 #include "config.h"
+#include "frame_arena.h"
+#include "frame_ring.h"
 #include "gsl.h"
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-function"
 #include "stb_truetype.h"
 #pragma GCC diagnostic pop
 #include <vector>
+#include <array>
+#include <iterator>
+#include <memory_resource>
 #include <any>
 #include <string>
 
@@ -27,8 +33,167 @@ namespace reig {
             int bitmap_width = 0;
             int bitmap_height = 0;
         };
+
+        enum class DrawCallType : uint32_t {
+            kText,
+            kRectangle,
+            kTexturedRectangle,
+            kBorderedRectangle,
+            kGradientRectangle,
+            kRoundedRectangle,
+            kCircle,
+            kPolyline,
+            kCachedRegion,
+        };
+
+        /**
+         * @brief The arguments of a primitive render in a cached window, recorded relative to the window's origin
+         * Everything up to the text is plain data without padding, hashed by its bytes
+         */
+        struct DrawCall {
+            DrawCallType type = DrawCallType::kRectangle;
+            int texture_id = 0;
+            primitive::Rectangle rect;
+            primitive::Rectangle clip_rect;
+            primitive::Transform transform;
+            std::array<primitive::Color, 4> colors;
+            /**
+             * The text's scale, the border's thickness, the corners' or the circle's radius or the line's thickness
+             */
+            float value = 0.0f;
+            text::Alignment alignment = text::Alignment::kCenter;
+            const char* text = nullptr;
+            const primitive::Point* points = nullptr;
+            std::size_t point_count = 0;
+            /**
+             * The index of the cached region, whose geometry the call appends
+             */
+            std::size_t region_index = 0;
+        };
+
+        /**
+         * @brief The geometry of a part of the gui, that is reused while its version stays the same
+         */
+        struct CachedRegion {
+            explicit CachedRegion(gsl::czstring id)
+                    : id{id}, draw_data{std::pmr::get_default_resource()} {}
+
+            gsl::czstring id = nullptr;
+            std::uint64_t version = 0;
+            std::uint64_t cache_generation = 0;
+            bool is_recorded = false;
+            unsigned last_used_frame = 0;
+            /**
+             * Relative to the draw origin, with the clip rectangles and transforms, the region was recorded with
+             */
+            DrawData draw_data;
+            /**
+             * The rects, which the region's widgets fitted into their window, before the fitting
+             */
+            std::vector<primitive::Rectangle> fitted_rects;
+            /**
+             * The same rects after the fitting, relative to the draw origin, where the region's widgets take input
+             */
+            std::vector<primitive::Rectangle> hit_rects;
+        };
     }
 
+    struct FrameStatistics {
+        /**
+         * How many blocks the frame arena allocated from the heap, for the frame's transient data.
+         * Zero in a steady state. Only the arena is counted, not the other allocations, e.g. those of
+         * the window caches or the frame snapshots, which keep their memory between frames too
+         */
+        std::size_t arena_block_allocations = 0;
+
+        /**
+         * How many commands were emitted by the widgets and the windows
+         */
+        std::size_t emitted_commands = 0;
+
+        /**
+         * How many of the emitted commands were dropped as invisible, zero unless the culling is enabled
+         */
+        primitive::CullStatistics culled_commands;
+
+        /**
+         * How many commands were passed to the render handler, after the batching
+         */
+        std::size_t batched_commands = 0;
+
+        /**
+         * How many layers were passed to the render handler, and how many of them were the same as in the last frame,
+         * the latter only with Config::change_tracking
+         */
+        std::size_t layers = 0;
+        std::size_t unchanged_layers = 0;
+
+        /**
+         * How many windows reused their geometry from the last frame, zero unless the window caching is enabled
+         */
+        std::size_t cached_windows = 0;
+
+        /**
+         * How many cached regions were replayed, instead of running their widgets
+         */
+        std::size_t cached_regions = 0;
+
+        /**
+         * How many windows were wholly covered by other windows, so their widgets' recorded renders were dropped
+         */
+        std::size_t occluded_windows = 0;
+
+        /**
+         * How many published frames this one replaced, because the render thread didn't acquire them in time.
+         * Zero unless the buffered submission is used
+         */
+        std::size_t dropped_frames = 0;
+    };
+
+    /**
+     * @class FrameSnapshot
+     * @brief A copy of a finished frame, that the render thread reads while the next frame is built
+     * It replaces frames, that were dropped before it, so its damage and unchanged flags are relative to
+     * the frame acquired before it
+     */
+    class FrameSnapshot {
+    public:
+        /**
+         * @return The number of layers, in the order the render handler would get them
+         */
+        std::size_t layer_count() const;
+
+        const DrawData& layer(std::size_t index) const;
+
+        /**
+         * @brief Returns the areas of the screen, that changed since the previously acquired frame
+         */
+        const std::vector<primitive::Rectangle>& damage_rects() const;
+
+        /**
+         * @brief Returns true if nothing on the screen changed since the previously acquired frame
+         * Always false unless Config::change_tracking is enabled
+         */
+        bool is_unchanged() const;
+
+        const FrameStatistics& statistics() const;
+
+        unsigned frame_counter() const;
+
+    private:
+        friend class Context;
+
+        /**
+         * The layers' lists are kept between the frames, only the first _layer_count ones are a part of the frame
+         */
+        std::vector<DrawData> _layers;
+        std::size_t _layer_count = 0;
+        std::vector<primitive::Rectangle> _damage_rects;
+        bool _is_unchanged = false;
+        FrameStatistics _statistics;
+        unsigned _frame_counter = 0;
+    };
+
     /**
      * @class Context
      * @brief Used to pump in input and request gui creation
@@ -45,6 +210,8 @@ namespace reig {
          * @brief Set's a user function, which will draw the gui, based
          * @param render_handler A C function pointer to a rendering callback
          * The handler should return void and take in const DrawData& and void*
+         * It is called once per layer, with the layer's geometry packed into flat buffers.
+         * Not needed with the buffered frame submission
          */
         void set_render_handler(RenderHandler render_handler);
 
@@ -75,11 +242,60 @@ namespace reig {
 
         unsigned get_frame_counter() const;
 
+        /**
+         * @brief Returns the statistics of the last finished frame
+         */
+        const FrameStatistics& get_frame_statistics() const;
+
+        /**
+         * @brief Returns true if the last finished frame passed the same layers to the render handler
+         * as the one before, in the same order. Nothing on the screen has changed then.
+         * Always false unless Config::change_tracking is enabled
+         */
+        bool is_frame_unchanged() const;
+
+        /**
+         * @brief Returns the areas of the screen, that changed in the last finished frame, in screen coordinates
+         * A window, that moved, changed its z-order or any of its content, damages its old and its new full rect.
+         * The free layer damages the area covered by its old and new geometry. Overlapping areas are merged.
+         * Empty if the frame is unchanged. Without Config::change_tracking every layer damages its areas
+         */
+        const std::vector<primitive::Rectangle>& get_damage_rects() const;
+
+        /**
+         * @brief Sets the size of the screen area, that the render handler draws to
+         * Widgets, that fall wholly outside of it, are skipped. Unbounded until set
+         */
+        void set_viewport_size(float width, float height);
+
+        const primitive::Rectangle& get_viewport_rect() const;
+
+        /**
+         * @brief Returns the memory resource, that is reset at each start_frame
+         * It can be used by the user for data that doesn't outlive the frame
+         */
+        std::pmr::memory_resource* get_frame_memory_resource();
+
         /**
          * @brief Uses stored drawData and draws everything using the user handler
+         * With the buffered frame submission, the layers are copied into a snapshot for the render thread instead
          */
         void end_frame();
 
+        /**
+         * @brief Takes the oldest frame published by end_frame, with the buffered frame submission
+         * Meant for a render thread, it may run concurrently with everything on the UI thread, except set_config.
+         * The snapshot stays unchanged until release_frame, only one can be held at a time
+         * @return Nullptr if no frame was published since the last one was acquired
+         * @throws std::logic_error if a frame is already acquired
+         */
+        const FrameSnapshot* acquire_frame();
+
+        /**
+         * @brief Gives the acquired frame back, so that end_frame can reuse its snapshot
+         */
+        void release_frame();
+
         // Inputs
         detail::Mouse mouse;
         detail::Keyboard keyboard;
@@ -88,8 +304,12 @@ namespace reig {
         /**
          * Starts a new window, with the given title and starting coordinates.
          * The windows is given an id, that is equals to the title
+         * @return False if the window's content won't be drawn, e.g. when it's collapsed, outside of the viewport or
+         * was covered by other windows in the last frame. Widgets are still needed to size the window, but expensive
+         * content can be skipped. If the cover moved away, the skipped content is missing for one frame
+         * and the window is damaged again in the next one
          */
-        void start_window(gsl::czstring title, float default_x, float default_y);
+        bool start_window(gsl::czstring title, float default_x, float default_y);
 
         /**
          * Same as start_window without the id parameter.
@@ -97,12 +317,68 @@ namespace reig {
          * Starts a new window, with the given id, title and starting coordinates.
          * Use this one with a constant id, if you know the window title can change
          */
-        void start_window(gsl::czstring id, gsl::czstring title, float default_x, float default_y);
+        bool start_window(gsl::czstring id, gsl::czstring title, float default_x, float default_y);
 
         void end_window();
 
         void fit_rect_in_window(primitive::Rectangle& rect);
 
+        /**
+         * @brief Returns false if nothing rendered in the rect would be seen, so a widget can skip its layout
+         * The rect is hidden in a collapsed or covered window, left of or above the window's body, outside of the clip
+         * rectangle or outside of the viewport. Cached regions only check the clip rectangle, as they outlive the
+         * window's position, and so does a window, while it's dragged
+         * @param rect The rect in the same coordinates as the widgets, after fit_rect_in_window
+         */
+        bool is_rect_visible(const primitive::Rectangle& rect) const;
+
+        /**
+         * @brief Starts a region, whose geometry is reused while its version stays the same
+         * The widgets of the region only have to run, when this returns true. Otherwise the region's geometry
+         * and the rects it fitted into the window are replayed from the last time it ran.
+         * The geometry keeps the clip rectangles and the transforms it was recorded with,
+         * so anything changing them or the region's content has to change the version too.
+         * The widgets also run while the cursor is over one of the rects they fitted, or the last click was in one,
+         * so they keep taking input, e.g. a selected entry its keys.
+         * Must be matched with end_cached_region, whatever it returns. Nested regions are a part of the outer one
+         * @param id The region's identifier, compared by the pointer like the window ids
+         * @return True if the region's widgets have to run
+         */
+        bool begin_cached_region(gsl::czstring id, std::uint64_t version);
+
+        void end_cached_region();
+
+        /**
+         * @brief Restricts the following renders to the rect, within the current clip rectangle
+         * Anything wholly outside is not emitted, the rest is recorded with the clip rectangle, for scissor tests.
+         * Must be matched with pop_clip_rect. Window bodies are clipped automatically
+         * @param rect The clip rectangle in the same coordinates as the widgets, e.g. after fit_rect_in_window
+         */
+        void push_clip_rect(const primitive::Rectangle& rect);
+
+        void pop_clip_rect();
+
+        /**
+         * @brief Returns the current clip rectangle on the screen, kUnclippedRect if none is pushed
+         */
+        const primitive::Rectangle& get_clip_rect() const;
+
+        /**
+         * @brief Scales and then translates the following renders and mouse hit tests, within the current transform
+         * The transform is relative to the current window's origin, or to the screen outside of windows.
+         * It is recorded on the draw commands, so a panned or zoomed canvas keeps its geometry.
+         * Must be matched with pop_transform
+         * @param scale The uniform scale, must be positive
+         */
+        void push_transform(const primitive::Point& translation, float scale = 1.0f);
+
+        void pop_transform();
+
+        /**
+         * @brief Returns the current transform, the identity if none is pushed
+         */
+        const primitive::Transform& get_transform() const;
+
         // Primitive renders
         /**
          * @brief Render some text
@@ -126,26 +402,221 @@ namespace reig {
          */
         void render_rectangle(const primitive::Rectangle& rect, int texture_id);
 
+        /**
+         * @brief Schedules a filled rectangle with a border, drawn inside of its edges
+         * Looks the same as a rectangle of the border color, with the fill nested over it, also when the fill is
+         * translucent. Cheaper than nesting rectangles, the border and the fill share the vertices of a single figure
+         * @param rect Position and size, including the border
+         * @param border_thickness The width of the border, clamped to half of the rect's smaller side
+         */
+        void render_bordered_rectangle(const primitive::Rectangle& rect, const primitive::Color& fill_color,
+                                       const primitive::Color& border_color, float border_thickness = 1.0f);
+
+        /**
+         * @brief Schedules a rectangle, with the colors interpolated between its corners
+         */
+        void render_gradient_rectangle(const primitive::Rectangle& rect,
+                                       const primitive::Color& top_left, const primitive::Color& top_right,
+                                       const primitive::Color& bottom_right, const primitive::Color& bottom_left);
+
+        /**
+         * @brief Schedules a rectangle with rounded corners
+         * The corners' detail is chosen by their radius on the screen
+         * @param radius The radius of the corners, clamped to half of the rect's smaller side
+         */
+        void render_rounded_rectangle(const primitive::Rectangle& rect, float radius, const primitive::Color& color);
+
+        /**
+         * @brief Schedules a filled circle
+         * The number of segments is chosen by the radius on the screen, from 8 for small indicators up to 64
+         */
+        void render_circle(const primitive::Point& center, float radius, const primitive::Color& color);
+
+        /**
+         * @brief Schedules an anti-aliased line strip through the points, as a single command
+         * The edges get a one pixel alpha fringe on the screen. Lines thinner than a pixel fade out instead.
+         * A strip of 100k points takes about 2 ms on one core, twice the 1 ms it's meant to take: half of it writes
+         * the 15 MB of vertices and indices, the rest is a square root and two divisions per point.
+         * A strip, that doesn't change every frame, is better drawn in a cached region
+         * @param points Pointer to the first of the points
+         * @param point_count The number of the points, at least 2 are needed for a line
+         */
+        void render_polyline(const primitive::Point* points, std::size_t point_count, float thickness,
+                             const primitive::Color& color);
+
+        /**
+         * @brief Schedules an anti-aliased line strip through a contiguous range of points
+         */
+        template <typename Points>
+        void render_polyline(const Points& points, float thickness, const primitive::Color& color) {
+            render_polyline(std::data(points), std::size(points), thickness, color);
+        }
+
     private:
         DrawData* get_current_draw_data_buffer();
 
+        /**
+         * @brief Returns the screen position, relative to which the current geometry is recorded
+         * Window widgets are recorded relative to the window, so a moved window needs no new geometry
+         */
+        primitive::Point get_draw_origin() const;
+
+        /**
+         * @brief Maps a rectangle from the widgets' coordinates to the screen, by the origin and the transform
+         */
+        primitive::Rectangle to_screen_space(const primitive::Rectangle& rect) const;
+
+        /**
+         * @brief Maps a point from the screen to the widgets' coordinates, for the hit tests
+         */
+        primitive::Point to_widget_space(const primitive::Point& point) const;
+
+        /**
+         * @brief Starts a command with the current clip rectangle and transform
+         */
+        void start_command(DrawData& draw_data, int texture_id, const primitive::Rectangle& clip_rect);
+
         float render_text(DrawData& draw_data, gsl::czstring text, primitive::Rectangle rect,
                           text::Alignment alignment = text::Alignment::kCenter, float scale = 1.0f);
 
-        static void render_rectangle(DrawData& draw_data, const primitive::Rectangle& rect,
-                                     const primitive::Color& color);
+        void render_rectangle(DrawData& draw_data, const primitive::Rectangle& rect, const primitive::Color& color);
+
+        void render_rectangle(DrawData& draw_data, const primitive::Rectangle& rect, int texture_id);
+
+        void render_bordered_rectangle(DrawData& draw_data, const primitive::Rectangle& rect,
+                                       const primitive::Color& fill_color, const primitive::Color& border_color,
+                                       float border_thickness, bool is_border_under_fill);
+
+        /**
+         * @brief Appends the glyph quads of a text run, as a single command using the font texture
+         * Glyphs outside of the clip rectangle are skipped
+         */
+        void render_text_quads(DrawData& draw_data, const std::pmr::vector<stbtt_aligned_quad>& quads,
+                               float horizontal_alignment, float vertical_alignment, int font_texture_id,
+                               const primitive::Rectangle& clip_rect);
+
+        /**
+         * @brief Sets the output format of the draw data from the config
+         */
+        void configure_draw_data(DrawData& draw_data);
+
+        /**
+         * @brief Returns true if the primitive renders have to be recorded for the window cache or an occluded window,
+         * instead of emitted
+         */
+        bool is_recording_draw_calls() const;
+
+        /**
+         * @brief Appends a render of the current window, with the rect, clip rectangle and transform
+         * relative to the window's origin
+         */
+        detail::DrawCall& record_draw_call(detail::DrawCallType type, const primitive::Rectangle& rect);
 
-        static void render_rectangle(DrawData& draw_data, const primitive::Rectangle& rect, int texture_id);
+        /**
+         * @brief Gives the window the geometry of its recorded renders, from its cache if they are the same
+         * as in the last frame, or by emitting them otherwise
+         */
+        void flush_draw_calls(detail::Window& window);
 
-        static void render_text_quads(DrawData& draw_data, const std::vector<stbtt_aligned_quad>& quads,
-                                      float horizontal_alignment, float vertical_alignment, int font_texture_id);
+        /**
+         * @brief Emits the recorded renders into the current window's draw data
+         */
+        void replay_draw_calls();
+
+        /**
+         * @brief Keeps the occluded window's recorded renders, until render_windows knows if it's still covered
+         */
+        void defer_draw_calls(detail::Window& window);
+
+        /**
+         * @brief Gives the window, that turned out not to be covered, the geometry of its deferred renders
+         */
+        void flush_deferred_draw_calls(detail::Window& window);
+
+        /**
+         * @brief Appends the region's geometry to the current draw data, or records it if a window is cached
+         */
+        void add_cached_region(std::size_t region_index);
+
+        /**
+         * @brief Returns true if the cursor or the last click is in one of the region's hit rects
+         */
+        bool is_cached_region_hit(const detail::CachedRegion& region) const;
+
+        /**
+         * @brief Lays the text's glyphs out from the rect's bottom left corner, until they pass its right edge
+         * @return The x coordinate after the last glyph
+         */
+        float layout_text(gsl::czstring text, const primitive::Rectangle& rect, float scale,
+                          std::pmr::vector<stbtt_aligned_quad>& quads);
 
         void render_windows();
 
+        /**
+         * @brief Generates the window's header, minimize button, title and frame into the chrome's draw data
+         * @param is_focused Whether the window is the topmost one, the others have dimmed frames
+         */
+        void render_window_chrome(const detail::Window& window, bool is_focused);
+
+        /**
+         * @return A hash of everything the window's chrome is generated from
+         */
+        std::uint64_t get_chrome_fingerprint(const detail::Window& window, bool is_focused) const;
+
+        /**
+         * @brief Culls and batches the layer's commands, passes it to the render handler and clears it
+         * @param previous_hash The layer's content hash in the last frame, to tell if it's unchanged
+         * @param reorder_commands Whether the commands are grouped by texture before the batching
+         */
+        void render_layer(DrawData& draw_data, std::uint64_t previous_hash, bool reorder_commands = false);
+
+        /**
+         * @brief Marks the area of the screen as changed, empty rectangles are ignored
+         */
+        void add_damage_rect(const primitive::Rectangle& rect);
+
+        /**
+         * @brief Takes a snapshot for the frame's layers, replacing the newest unacquired frame, if none is free
+         */
+        void begin_frame_snapshot();
+
+        /**
+         * @brief Copies the layer into the frame's snapshot, with its unchanged flag relative to any replaced frame
+         */
+        void add_snapshot_layer(const DrawData& draw_data);
+
+        void publish_frame_snapshot();
+
+        /**
+         * @brief Recreates the snapshots, if the submission changed
+         */
+        void configure_frame_ring();
+
         void update_window_layers();
 
         void remove_unqueued_windows();
 
+        /**
+         * @brief Returns true if the window was wholly inside an opaque window above it, in the last frame
+         * Only a guess, the windows' rects of the last frame are compared one by one. It's confirmed by
+         * is_window_covered once the frame ends. Nothing is occluded while a click or a drag could change what
+         * covers what
+         */
+        bool is_window_occluded(const detail::Window& window) const;
+
+        /**
+         * @brief Returns true if the window's body is wholly inside one of the windows above it,
+         * by their final rects in this frame
+         */
+        bool is_window_covered(const detail::Window& window) const;
+
+        /**
+         * @brief Returns false while a click or a drag may still move, reorder or collapse the windows this frame
+         */
+        bool are_windows_settled() const;
+
+        bool is_screen_rect_visible(const primitive::Rectangle& rect) const;
+
         bool claim_window_focus(const detail::Window& window);
 
         bool release_window_focus(const detail::Window& window);
@@ -159,10 +630,36 @@ namespace reig {
         friend ::reig::detail::Mouse;
         friend ::reig::detail::MouseButton;
 
+        // Declared before everything that allocates from it
+        detail::FrameArena _frame_arena;
+
         gsl::czstring _dragged_window = nullptr;
         detail::Window* _queued_window = nullptr;
         std::vector<detail::Window> _windows;
         DrawData _free_draw_data;
+        DrawData _chrome_draw_data;
+        std::vector<primitive::Rectangle> _clip_rects;
+        std::vector<primitive::Transform> _transforms;
+        std::pmr::vector<detail::DrawCall> _draw_calls;
+        /**
+         * The recorded renders of all the occluded windows of the frame, each window keeps its range
+         */
+        std::pmr::vector<detail::DrawCall> _deferred_draw_calls;
+        bool _is_replaying_draw_calls = false;
+        /**
+         * The texts recorded in the current window so far, the index of the next one in its cached text ends
+         */
+        std::size_t _recorded_text_count = 0;
+        /**
+         * Changed with anything, that affects the geometry besides the renders, to invalidate the window caches
+         */
+        std::uint64_t _cache_generation = 0;
+        std::size_t _cached_window_count = 0;
+        std::vector<detail::CachedRegion> _cached_regions;
+        detail::CachedRegion* _recording_region = nullptr;
+        std::size_t _cached_region_depth = 0;
+        std::size_t _replayed_region_count = 0;
+        std::size_t _occluded_window_count = 0;
 
         detail::Font _font;
         Config _config;
@@ -170,6 +667,26 @@ namespace reig {
         RenderHandler _render_handler = nullptr;
         std::any _user_ptr;
         unsigned _frame_counter = 0;
+        FrameStatistics _frame_statistics;
+        std::uint64_t _frame_hash = 0;
+        bool _is_frame_unchanged = false;
+        std::vector<primitive::Rectangle> _damage_rects;
+        primitive::Rectangle _free_layer_rect;
+        primitive::Rectangle _viewport_rect = primitive::kUnclippedRect;
+
+        detail::FrameRing _frame_ring;
+        std::vector<FrameSnapshot> _frame_snapshots;
+        /**
+         * Touched only by end_frame, while it writes a snapshot
+         */
+        FrameSnapshot* _writing_snapshot = nullptr;
+        std::size_t _writing_slot = detail::FrameRing::kNoSlot;
+        bool _is_replacing_snapshot = false;
+        std::size_t _replaced_layer_count = 0;
+        /**
+         * Touched only by the render thread
+         */
+        std::size_t _acquired_slot = detail::FrameRing::kNoSlot;
     };
 }
 
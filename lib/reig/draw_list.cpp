@@ -0,0 +1,922 @@
+#include "draw_list.h"
+#include "maths.h"
+#include "tessellation.h"
+#include "hash.h"
+#include <limits>
+#include <algorithm>
+#include <iterator>
+#include <array>
+#include <cmath>
+#include <type_traits>
+
+using std::pmr::vector;
+
+namespace reig::primitive {
+    /**
+     * @brief Copies the range of the source to the end of the destination
+     * @return The offset of the copy in the destination
+     */
+    template <typename Buffer>
+    uint32_t append_range(Buffer& destination, const Buffer& source, uint32_t offset, uint32_t count) {
+        auto appended_offset = static_cast<uint32_t>(destination.size());
+        auto begin = source.begin() + offset;
+        destination.insert(destination.end(), begin, begin + count);
+        return appended_offset;
+    }
+
+    /**
+     * @brief Makes room for appending the count of elements, still growing the capacity geometrically
+     */
+    template <typename Buffer>
+    void reserve_for_append(Buffer& destination, std::size_t count) {
+        auto required = destination.size() + count;
+        if (required > destination.capacity()) {
+            destination.reserve(math::max(required, destination.capacity() * 2));
+        }
+    }
+
+    /**
+     * @brief Mixes the bytes of the buffer's elements into the hash
+     */
+    template <typename Buffer>
+    std::uint64_t hash_buffer(const Buffer& buffer, std::uint64_t hash) {
+        using T = typename Buffer::value_type;
+        static_assert(std::is_trivially_copyable_v<T>, "Only plain data is hashed by its bytes");
+        return detail::hash_bytes(buffer.data(), buffer.size() * sizeof(T), hash);
+    }
+
+    const std::vector<Index>& get_quad_list_indices() {
+        static const std::vector<Index> indices = [] {
+            std::vector<Index> quad_indices;
+            quad_indices.reserve(kMaxQuadListVertices / 4 * 6);
+            for (std::size_t base = 0; base < kMaxQuadListVertices; base += 4) {
+                auto index = static_cast<Index>(base);
+                quad_indices.insert(quad_indices.end(), {index, static_cast<Index>(index + 1),
+                                                         static_cast<Index>(index + 2), static_cast<Index>(index + 2),
+                                                         static_cast<Index>(index + 3), index});
+            }
+            return quad_indices;
+        }();
+        return indices;
+    }
+
+    Rectangle get_screen_bounds(const DrawCommand& command) {
+        return transform_rect(command.transform, command.bounds);
+    }
+
+    DrawList::DrawList(std::pmr::memory_resource* resource)
+            : _vertices{resource}, _positions{resource}, _tex_coords{resource}, _colors{resource},
+              _indices{resource}, _commands{resource}, _instances{resource} {}
+
+    const GeometryBuffer<DrawVertex>& DrawList::vertices() const {
+        return _vertices;
+    }
+
+    const GeometryBuffer<Point>& DrawList::positions() const {
+        return _positions;
+    }
+
+    const GeometryBuffer<Point>& DrawList::tex_coords() const {
+        return _tex_coords;
+    }
+
+    const GeometryBuffer<Color>& DrawList::colors() const {
+        return _colors;
+    }
+
+    const GeometryBuffer<Index>& DrawList::indices() const {
+        return _indices;
+    }
+
+    const vector<DrawCommand>& DrawList::commands() const {
+        return _commands;
+    }
+
+    const vector<QuadInstance>& DrawList::instances() const {
+        return _instances;
+    }
+
+    bool DrawList::empty() const {
+        return _commands.empty();
+    }
+
+    GeometryOutput DrawList::geometry_output() const {
+        return _geometry_output;
+    }
+
+    void DrawList::set_geometry_output(GeometryOutput geometry_output) {
+        _geometry_output = geometry_output;
+    }
+
+    VertexStreams DrawList::vertex_streams() const {
+        return _vertex_streams;
+    }
+
+    void DrawList::set_vertex_streams(VertexStreams vertex_streams) {
+        _vertex_streams = vertex_streams;
+    }
+
+    std::uint64_t DrawList::content_hash() const {
+        return _content_hash;
+    }
+
+    bool DrawList::is_unchanged() const {
+        return _is_unchanged;
+    }
+
+    void DrawList::update_content_hash(std::uint64_t previous_hash) {
+        auto hash = static_cast<std::uint64_t>(_geometry_output) << 8 | static_cast<std::uint64_t>(_vertex_streams);
+        hash = hash_buffer(_commands, hash);
+        hash = hash_buffer(_vertices, hash);
+        hash = hash_buffer(_positions, hash);
+        hash = hash_buffer(_tex_coords, hash);
+        hash = hash_buffer(_colors, hash);
+        hash = hash_buffer(_indices, hash);
+        hash = hash_buffer(_instances, hash);
+        _content_hash = hash;
+        _is_unchanged = hash == previous_hash;
+    }
+
+    std::size_t DrawList::vertex_count() const {
+        return _vertex_streams == VertexStreams::kSeparate ? _positions.size() : _vertices.size();
+    }
+
+    std::size_t DrawList::max_command_vertices() const {
+        return _geometry_output == GeometryOutput::kQuadList ? kMaxQuadListVertices : kMaxCommandVertices;
+    }
+
+    bool DrawList::has_indices() const {
+        return _geometry_output != GeometryOutput::kQuadList;
+    }
+
+    void DrawList::clear() {
+        _expected_vertex_count = vertex_count();
+        _expected_index_count = _indices.size();
+        _expected_command_count = _commands.size();
+        _expected_instance_count = _instances.size();
+        _vertices.clear();
+        _positions.clear();
+        _tex_coords.clear();
+        _colors.clear();
+        _indices.clear();
+        _commands.clear();
+        _instances.clear();
+    }
+
+    void DrawList::release() {
+        auto* resource = _commands.get_allocator().resource();
+        _vertices = GeometryBuffer<DrawVertex>{resource};
+        _positions = GeometryBuffer<Point>{resource};
+        _tex_coords = GeometryBuffer<Point>{resource};
+        _colors = GeometryBuffer<Color>{resource};
+        _indices = GeometryBuffer<Index>{resource};
+        _commands = vector<DrawCommand>{resource};
+        _instances = vector<QuadInstance>{resource};
+    }
+
+    void DrawList::assign(const DrawList& other) {
+        _vertices = other._vertices;
+        _positions = other._positions;
+        _tex_coords = other._tex_coords;
+        _colors = other._colors;
+        _indices = other._indices;
+        _commands = other._commands;
+        _instances = other._instances;
+        _geometry_output = other._geometry_output;
+        _vertex_streams = other._vertex_streams;
+    }
+
+    void DrawList::append(const DrawList& other) {
+        auto vertex_offset = static_cast<uint32_t>(vertex_count());
+        auto index_offset = static_cast<uint32_t>(_indices.size());
+        auto instance_offset = static_cast<uint32_t>(_instances.size());
+
+        _vertices.insert(_vertices.end(), other._vertices.begin(), other._vertices.end());
+        _positions.insert(_positions.end(), other._positions.begin(), other._positions.end());
+        _tex_coords.insert(_tex_coords.end(), other._tex_coords.begin(), other._tex_coords.end());
+        _colors.insert(_colors.end(), other._colors.begin(), other._colors.end());
+        _indices.insert(_indices.end(), other._indices.begin(), other._indices.end());
+        _instances.insert(_instances.end(), other._instances.begin(), other._instances.end());
+        // The indices are relative to their command, only the offsets need to be moved
+        for (auto command : other._commands) {
+            command.vertex_offset += vertex_offset;
+            command.index_offset += has_indices() ? index_offset : 0u;
+            command.instance_offset += instance_offset;
+            _commands.push_back(command);
+        }
+    }
+
+    void DrawList::reorder_commands() {
+        auto command_count = _commands.size();
+        if (command_count < 3) return;
+
+        // How many runs back a command may travel, keeps the pass linear for big lists
+        std::size_t const max_lookback = 32;
+        std::size_t const no_command = std::numeric_limits<std::size_t>::max();
+
+        struct Run {
+            // On the screen, as the commands may have different transforms
+            Rectangle bounds;
+            int texture_id = 0;
+            std::size_t first = 0;
+            std::size_t last = 0;
+        };
+
+        auto* resource = _commands.get_allocator().resource();
+        vector<Run> runs{resource};
+        vector<std::size_t> next_in_run(command_count, no_command, resource);
+
+        auto is_overlapping_run = [&](const Run& run, const Rectangle& bounds) {
+            if (!is_rect_overlapping(run.bounds, bounds)) return false;
+            for (auto i = run.first; i != no_command; i = next_in_run[i]) {
+                if (is_rect_overlapping(get_screen_bounds(_commands[i]), bounds)) return true;
+            }
+            return false;
+        };
+
+        bool has_moved = false;
+        for (std::size_t i = 0; i < command_count; ++i) {
+            const auto& command = _commands[i];
+            auto bounds = get_screen_bounds(command);
+
+            auto target = runs.rend();
+            std::size_t lookback = 0;
+            for (auto it = runs.rbegin(); it != runs.rend() && lookback < max_lookback; ++it, ++lookback) {
+                if (it->texture_id == command.texture_id) {
+                    target = it;
+                    break;
+                }
+                if (is_overlapping_run(*it, bounds)) break;
+            }
+
+            if (target != runs.rend()) {
+                has_moved = has_moved || target != runs.rbegin();
+                next_in_run[target->last] = i;
+                target->last = i;
+                target->bounds = get_bounding_rect(target->bounds, bounds);
+            } else {
+                runs.push_back(Run{bounds, command.texture_id, i, i});
+            }
+        }
+        if (!has_moved) return;
+
+        auto reserved = [resource](const auto& source) {
+            std::remove_const_t<std::remove_reference_t<decltype(source)>> copy{resource};
+            copy.reserve(source.size());
+            return copy;
+        };
+        auto vertices = reserved(_vertices);
+        auto positions = reserved(_positions);
+        auto tex_coords = reserved(_tex_coords);
+        auto colors = reserved(_colors);
+        auto indices = reserved(_indices);
+        auto commands = reserved(_commands);
+        auto instances = reserved(_instances);
+        bool is_separate = _vertex_streams == VertexStreams::kSeparate;
+        for (const auto& run : runs) {
+            for (auto i = run.first; i != no_command; i = next_in_run[i]) {
+                auto command = _commands[i];
+                if (is_separate) {
+                    append_range(positions, _positions, command.vertex_offset, command.vertex_count);
+                    append_range(tex_coords, _tex_coords, command.vertex_offset, command.vertex_count);
+                    command.vertex_offset = append_range(colors, _colors, command.vertex_offset, command.vertex_count);
+                } else {
+                    command.vertex_offset = append_range(vertices, _vertices, command.vertex_offset,
+                                                         command.vertex_count);
+                }
+                if (has_indices()) {
+                    command.index_offset = append_range(indices, _indices, command.index_offset, command.index_count);
+                }
+                command.instance_offset = append_range(instances, _instances, command.instance_offset,
+                                                       command.instance_count);
+                commands.push_back(command);
+            }
+        }
+        _vertices.swap(vertices);
+        _positions.swap(positions);
+        _tex_coords.swap(tex_coords);
+        _colors.swap(colors);
+        _indices.swap(indices);
+        _commands.swap(commands);
+        _instances.swap(instances);
+    }
+
+    bool DrawList::can_merge(const DrawCommand& left, const DrawCommand& right) const {
+        if (left.texture_id != right.texture_id) return false;
+        if (!is_same_rect(left.clip_rect, right.clip_rect)) return false;
+        if (!is_same_transform(left.transform, right.transform)) return false;
+
+        bool is_left_instanced = left.instance_count > 0;
+        bool is_right_instanced = right.instance_count > 0;
+        if (is_left_instanced || is_right_instanced) {
+            return is_left_instanced == is_right_instanced
+                   && left.instance_offset + left.instance_count == right.instance_offset;
+        }
+
+        return left.vertex_count + right.vertex_count <= max_command_vertices()
+               && left.vertex_offset + left.vertex_count == right.vertex_offset
+               && (!has_indices() || left.index_offset + left.index_count == right.index_offset);
+    }
+
+    std::size_t DrawList::merge_commands() {
+        if (_commands.empty()) return 0;
+
+        std::size_t last = 0;
+        for (std::size_t i = 1; i < _commands.size(); ++i) {
+            auto& merged = _commands[last];
+            const auto& next = _commands[i];
+            if (can_merge(merged, next)) {
+                if (has_indices()) {
+                    auto rebase = next.vertex_offset - merged.vertex_offset;
+                    auto begin = _indices.begin() + next.index_offset;
+                    auto end = begin + next.index_count;
+                    for (auto it = begin; it != end; ++it) {
+                        *it = static_cast<Index>(*it + rebase);
+                    }
+                }
+                merged.bounds = get_bounding_rect(merged.bounds, next.bounds);
+                merged.vertex_count += next.vertex_count;
+                merged.index_count += next.index_count;
+                merged.instance_count += next.instance_count;
+            } else {
+                _commands[++last] = next;
+            }
+        }
+        _commands.resize(last + 1);
+        return _commands.size();
+    }
+
+    void DrawList::cull_commands(CullStatistics& statistics) {
+        // Every command is tested against at most this many occluders, keeps the pass linear for big lists
+        std::size_t const max_occluders = 16;
+
+        auto* resource = _commands.get_allocator().resource();
+        vector<Rectangle> occluders{resource};
+        occluders.reserve(max_occluders);
+        vector<bool> is_culled(_commands.size(), false, resource);
+
+        bool has_culled = false;
+        // Backwards, so the occluders drawn after a command are known when it's reached
+        for (auto i = _commands.size(); i-- > 0;) {
+            const auto& command = _commands[i];
+            bool is_empty = command.vertex_count == 0 && command.instance_count == 0;
+            auto visible_rect = get_overlapping_rect(command.bounds, command.clip_rect);
+            auto screen_rect = transform_rect(command.transform, visible_rect);
+
+            if (is_empty || command.bounds.width <= 0.0f || command.bounds.height <= 0.0f) {
+                ++statistics.degenerate;
+            } else if (!is_rect_overlapping(command.bounds, command.clip_rect)) {
+                ++statistics.clipped;
+            } else if (is_transparent(command)) {
+                ++statistics.transparent;
+            } else if (std::any_of(occluders.begin(), occluders.end(), [&screen_rect](const Rectangle& occluder) {
+                return is_rect_in_rect(screen_rect, occluder);
+            })) {
+                ++statistics.occluded;
+            } else {
+                Rectangle opaque_rect;
+                if (occluders.size() < max_occluders && get_opaque_rect(command, opaque_rect)) {
+                    occluders.push_back(opaque_rect);
+                }
+                continue;
+            }
+            is_culled[i] = true;
+            has_culled = true;
+        }
+        if (!has_culled) return;
+
+        // The kept ranges only move towards the front, so the buffers are compacted in place
+        auto move_range = [](auto& buffer, std::size_t from, std::size_t count, std::size_t to) {
+            if (from == to) return;
+            auto begin = buffer.begin() + from;
+            std::copy(begin, begin + count, buffer.begin() + to);
+        };
+        bool is_separate = _vertex_streams == VertexStreams::kSeparate;
+        std::size_t kept_count = 0;
+        std::size_t vertex_end = 0;
+        std::size_t index_end = 0;
+        std::size_t instance_end = 0;
+        for (std::size_t i = 0; i < _commands.size(); ++i) {
+            if (is_culled[i]) continue;
+
+            auto command = _commands[i];
+            if (is_separate) {
+                move_range(_positions, command.vertex_offset, command.vertex_count, vertex_end);
+                move_range(_tex_coords, command.vertex_offset, command.vertex_count, vertex_end);
+                move_range(_colors, command.vertex_offset, command.vertex_count, vertex_end);
+            } else {
+                move_range(_vertices, command.vertex_offset, command.vertex_count, vertex_end);
+            }
+            command.vertex_offset = static_cast<uint32_t>(vertex_end);
+            vertex_end += command.vertex_count;
+            if (has_indices()) {
+                move_range(_indices, command.index_offset, command.index_count, index_end);
+                command.index_offset = static_cast<uint32_t>(index_end);
+                index_end += command.index_count;
+            }
+            move_range(_instances, command.instance_offset, command.instance_count, instance_end);
+            command.instance_offset = static_cast<uint32_t>(instance_end);
+            instance_end += command.instance_count;
+
+            _commands[kept_count++] = command;
+        }
+        resize_vertices(vertex_end);
+        _indices.resize(has_indices() ? index_end : 0);
+        _instances.resize(instance_end);
+        _commands.resize(kept_count);
+    }
+
+    bool DrawList::is_transparent(const DrawCommand& command) const {
+        // Textured commands may ignore their colors
+        if (command.texture_id != 0) return false;
+
+        if (command.instance_count > 0) {
+            auto begin = _instances.begin() + command.instance_offset;
+            return std::all_of(begin, begin + command.instance_count, [](const QuadInstance& instance) {
+                return instance.color.alpha == 0;
+            });
+        }
+        if (_vertex_streams == VertexStreams::kSeparate) {
+            auto begin = _colors.begin() + command.vertex_offset;
+            return std::all_of(begin, begin + command.vertex_count, [](const Color& color) {
+                return color.alpha == 0;
+            });
+        }
+        auto begin = _vertices.begin() + command.vertex_offset;
+        return std::all_of(begin, begin + command.vertex_count, [](const DrawVertex& vertex) {
+            return vertex.color.alpha == 0;
+        });
+    }
+
+    bool DrawList::get_opaque_rect(const DrawCommand& command, Rectangle& opaque_rect) const {
+        if (command.texture_id != 0) return false;
+
+        Rectangle rect;
+        if (command.instance_count == 1) {
+            const auto& instance = _instances[command.instance_offset];
+            if (instance.color.alpha != 255) return false;
+            rect = instance.rect;
+        } else if (command.instance_count == 0 && command.vertex_count == 4 && command.index_count == 6) {
+            // A quad of add_rect, with the vertices clockwise from the top left corner
+            Point positions[4];
+            for (std::size_t i = 0; i < 4; ++i) {
+                auto vertex = command.vertex_offset + i;
+                bool is_separate = _vertex_streams == VertexStreams::kSeparate;
+                positions[i] = is_separate ? _positions[vertex] : get_position(_vertices[vertex]);
+                if ((is_separate ? _colors[vertex] : _vertices[vertex].color).alpha != 255) return false;
+            }
+            bool is_axis_aligned = positions[0].y == positions[1].y && positions[1].x == positions[2].x
+                                   && positions[2].y == positions[3].y && positions[3].x == positions[0].x;
+            if (!is_axis_aligned) return false;
+            rect = {positions[0].x, positions[0].y, positions[2].x - positions[0].x, positions[2].y - positions[0].y};
+        } else {
+            return false;
+        }
+
+        // Only the clipped part is drawn. Shrunk to whole pixels, as the backends' scissor tests may round
+        auto screen_rect = transform_rect(command.transform, get_overlapping_rect(rect, command.clip_rect));
+        auto x = std::ceil(screen_rect.x);
+        auto y = std::ceil(screen_rect.y);
+        opaque_rect = {x, y, std::floor(get_x2(screen_rect)) - x, std::floor(get_y2(screen_rect)) - y};
+        return opaque_rect.width > 0.0f && opaque_rect.height > 0.0f;
+    }
+
+    void DrawList::clip_commands(const Rectangle& clip_rect) {
+        for (auto& command : _commands) {
+            auto command_clip_rect = inverse_transform_rect(command.transform, clip_rect);
+            command.clip_rect = get_overlapping_rect(command.clip_rect, command_clip_rect);
+        }
+    }
+
+    void DrawList::translate_commands(const Point& offset) {
+        for (auto& command : _commands) {
+            command.transform.translation.x += offset.x;
+            command.transform.translation.y += offset.y;
+        }
+    }
+
+    void DrawList::start_command(int texture_id, const Rectangle& clip_rect, const Transform& transform) {
+        if (_commands.capacity() == 0) {
+            if (_vertex_streams == VertexStreams::kSeparate) {
+                _positions.reserve(_expected_vertex_count);
+                _tex_coords.reserve(_expected_vertex_count);
+                _colors.reserve(_expected_vertex_count);
+            } else {
+                _vertices.reserve(_expected_vertex_count);
+            }
+            _indices.reserve(_expected_index_count);
+            _commands.reserve(_expected_command_count);
+            _instances.reserve(_expected_instance_count);
+        }
+
+        DrawCommand command;
+        command.texture_id = texture_id;
+        command.clip_rect = clip_rect;
+        command.transform = transform;
+        command.vertex_offset = static_cast<uint32_t>(vertex_count());
+        command.index_offset = has_indices() ? static_cast<uint32_t>(_indices.size()) : 0u;
+        command.instance_offset = static_cast<uint32_t>(_instances.size());
+        _commands.push_back(command);
+    }
+
+    void DrawList::split_command() {
+        auto current = _commands.back();
+        start_command(current.texture_id, current.clip_rect, current.transform);
+    }
+
+    DrawCommand& DrawList::prepare_vertex_command(std::size_t vertex_count) {
+        const auto& current = _commands.back();
+        if (current.instance_count > 0 || current.vertex_count + vertex_count > max_command_vertices()) {
+            split_command();
+        }
+        return _commands.back();
+    }
+
+    void DrawList::push_vertex(const Vertex& vertex) {
+        if (_vertex_streams == VertexStreams::kSeparate) {
+            _positions.push_back(vertex.position);
+            _tex_coords.push_back(vertex.texCoord);
+            _colors.push_back(vertex.color);
+        } else {
+            _vertices.push_back(VertexLayout::make(vertex));
+        }
+    }
+
+    void DrawList::resize_vertices(std::size_t count) {
+        if (_vertex_streams == VertexStreams::kSeparate) {
+            _positions.resize(count);
+            _tex_coords.resize(count);
+            _colors.resize(count);
+        } else {
+            _vertices.resize(count);
+        }
+    }
+
+    void DrawList::reserve_geometry(std::size_t vertex_count, std::size_t index_count) {
+        if (_vertex_streams == VertexStreams::kSeparate) {
+            reserve_for_append(_positions, vertex_count);
+            reserve_for_append(_tex_coords, vertex_count);
+            reserve_for_append(_colors, vertex_count);
+        } else {
+            reserve_for_append(_vertices, vertex_count);
+        }
+        reserve_for_append(_indices, index_count);
+    }
+
+    void DrawList::add_to_bounds(DrawCommand& command, const Rectangle& rect) {
+        bool is_empty = command.vertex_count == 0 && command.instance_count == 0;
+        command.bounds = is_empty ? rect : get_bounding_rect(command.bounds, rect);
+    }
+
+    void DrawList::add_quad(const Vertex& v0, const Vertex& v1, const Vertex& v2, const Vertex& v3) {
+        auto& command = prepare_vertex_command(4);
+        auto base = command.vertex_count;
+
+        auto min_x = math::min(math::min(v0.position.x, v1.position.x), math::min(v2.position.x, v3.position.x));
+        auto min_y = math::min(math::min(v0.position.y, v1.position.y), math::min(v2.position.y, v3.position.y));
+        auto max_x = math::max(math::max(v0.position.x, v1.position.x), math::max(v2.position.x, v3.position.x));
+        auto max_y = math::max(math::max(v0.position.y, v1.position.y), math::max(v2.position.y, v3.position.y));
+        add_to_bounds(command, {min_x, min_y, max_x - min_x, max_y - min_y});
+
+        push_vertex(v0);
+        push_vertex(v1);
+        push_vertex(v2);
+        push_vertex(v3);
+
+        if (has_indices()) {
+            auto index = static_cast<Index>(base);
+            _indices.push_back(index);
+            _indices.push_back(index + 1);
+            _indices.push_back(index + 2);
+            _indices.push_back(index + 2);
+            _indices.push_back(index + 3);
+            _indices.push_back(index);
+        }
+
+        command.vertex_count += 4;
+        command.index_count += 6;
+    }
+
+    void DrawList::add_rect(const Rectangle& rect, const Rectangle& tex_rect, const Color& color) {
+        if (_geometry_output != GeometryOutput::kInstanced) {
+            add_quad({{rect.x,       rect.y},       {tex_rect.x,       tex_rect.y},       color},
+                     {{get_x2(rect), rect.y},       {get_x2(tex_rect), tex_rect.y},       color},
+                     {{get_x2(rect), get_y2(rect)}, {get_x2(tex_rect), get_y2(tex_rect)}, color},
+                     {{rect.x,       get_y2(rect)}, {tex_rect.x,       get_y2(tex_rect)}, color});
+            return;
+        }
+
+        if (_commands.back().vertex_count > 0) {
+            split_command();
+        }
+        auto& command = _commands.back();
+
+        QuadInstance instance;
+        instance.rect = rect;
+        instance.u0 = CompactVertexLayout::quantize_tex_coord(tex_rect.x);
+        instance.v0 = CompactVertexLayout::quantize_tex_coord(tex_rect.y);
+        instance.u1 = CompactVertexLayout::quantize_tex_coord(get_x2(tex_rect));
+        instance.v1 = CompactVertexLayout::quantize_tex_coord(get_y2(tex_rect));
+        instance.color = color;
+        instance.texture_id = command.texture_id;
+        _instances.push_back(instance);
+
+        add_to_bounds(command, rect);
+        ++command.instance_count;
+    }
+
+    void DrawList::add_triangles(const Vertex* vertices, std::size_t vertex_count,
+                                 const Index* indices, std::size_t index_count) {
+        if (vertex_count == 0 || index_count == 0) return;
+
+        // Without indices every triangle becomes a quad, with its last vertex repeated
+        auto emitted_vertex_count = has_indices() ? vertex_count : index_count / 3 * 4;
+        auto& command = prepare_vertex_command(emitted_vertex_count);
+        auto base = command.vertex_count;
+
+        auto min = vertices[0].position;
+        auto max = vertices[0].position;
+        for (std::size_t i = 1; i < vertex_count; ++i) {
+            min = {math::min(min.x, vertices[i].position.x), math::min(min.y, vertices[i].position.y)};
+            max = {math::max(max.x, vertices[i].position.x), math::max(max.y, vertices[i].position.y)};
+        }
+        add_to_bounds(command, {min.x, min.y, max.x - min.x, max.y - min.y});
+
+        if (has_indices()) {
+            for (std::size_t i = 0; i < vertex_count; ++i) {
+                push_vertex(vertices[i]);
+            }
+            for (std::size_t i = 0; i < index_count; ++i) {
+                _indices.push_back(static_cast<Index>(base + indices[i]));
+            }
+            command.index_count += static_cast<uint32_t>(index_count);
+        } else {
+            for (std::size_t i = 0; i + 2 < index_count; i += 3) {
+                push_vertex(vertices[indices[i]]);
+                push_vertex(vertices[indices[i + 1]]);
+                push_vertex(vertices[indices[i + 2]]);
+                push_vertex(vertices[indices[i + 2]]);
+            }
+            command.index_count += static_cast<uint32_t>(emitted_vertex_count / 4 * 6);
+        }
+        command.vertex_count += static_cast<uint32_t>(emitted_vertex_count);
+    }
+
+    void DrawList::add_bordered_rect(const Rectangle& rect, float border_thickness,
+                                     const Color& fill_color, const Color& border_color, bool is_border_under_fill) {
+        // An opaque fill hides anything under it
+        is_border_under_fill = is_border_under_fill && fill_color.alpha < 255;
+        auto thickness = math::clamp(border_thickness, 0.0f, math::min(rect.width, rect.height) * 0.5f);
+        Rectangle inner{rect.x + thickness, rect.y + thickness, rect.width - thickness * 2, rect.height - thickness * 2};
+
+        if (_geometry_output != GeometryOutput::kIndexed) {
+            // Quads and instances can't share vertices, the border is split into four rectangles
+            add_rect({rect.x, rect.y, rect.width, thickness}, {}, border_color);
+            add_rect({rect.x, get_y2(inner), rect.width, thickness}, {}, border_color);
+            add_rect({rect.x, inner.y, thickness, inner.height}, {}, border_color);
+            add_rect({get_x2(inner), inner.y, thickness, inner.height}, {}, border_color);
+            if (is_border_under_fill) {
+                add_rect(inner, {}, border_color);
+            }
+            add_rect(inner, {}, fill_color);
+            return;
+        }
+
+        Vertex const vertices[] = {
+                {{rect.x,        rect.y},        {}, border_color},
+                {{get_x2(rect),  rect.y},        {}, border_color},
+                {{get_x2(rect),  get_y2(rect)},  {}, border_color},
+                {{rect.x,        get_y2(rect)},  {}, border_color},
+                {{inner.x,       inner.y},       {}, border_color},
+                {{get_x2(inner), inner.y},       {}, border_color},
+                {{get_x2(inner), get_y2(inner)}, {}, border_color},
+                {{inner.x,       get_y2(inner)}, {}, border_color},
+                {{inner.x,       inner.y},       {}, fill_color},
+                {{get_x2(inner), inner.y},       {}, fill_color},
+                {{get_x2(inner), get_y2(inner)}, {}, fill_color},
+                {{inner.x,       get_y2(inner)}, {}, fill_color},
+        };
+        Index const indices[] = {
+                4, 5, 6, 6, 7, 4, // The border color under the fill
+                0, 1, 5, 5, 4, 0, // Top
+                1, 2, 6, 6, 5, 1, // Right
+                2, 3, 7, 7, 6, 2, // Bottom
+                3, 0, 4, 4, 7, 3, // Left
+                8, 9, 10, 10, 11, 8, // Fill
+        };
+        std::size_t skipped_index_count = is_border_under_fill ? 0 : 6;
+        add_triangles(vertices, std::size(vertices),
+                      indices + skipped_index_count, std::size(indices) - skipped_index_count);
+    }
+
+    void DrawList::add_circle(const Point& center, float radius, const std::vector<Point>& unit_circle,
+                              const Color& color) {
+        auto segment_count = math::min(unit_circle.size(), detail::kMaxCircleSegments);
+        std::array<Vertex, detail::kMaxCircleSegments + 1> vertices;
+        std::array<Index, detail::kMaxCircleSegments * 3> indices;
+
+        vertices[0] = {center, {}, color};
+        for (std::size_t i = 0; i < segment_count; ++i) {
+            const auto& point = unit_circle[i];
+            vertices[i + 1] = {{center.x + point.x * radius, center.y + point.y * radius}, {}, color};
+            indices[i * 3] = 0;
+            indices[i * 3 + 1] = static_cast<Index>(i + 1);
+            indices[i * 3 + 2] = static_cast<Index>((i + 1) % segment_count + 1);
+        }
+        add_triangles(vertices.data(), segment_count + 1, indices.data(), segment_count * 3);
+    }
+
+    void DrawList::add_rounded_rect(const Rectangle& rect, float radius, const std::vector<Point>& unit_circle,
+                                    const Color& color) {
+        radius = math::clamp(radius, 0.0f, math::min(rect.width, rect.height) * 0.5f);
+        auto segment_count = math::min(unit_circle.size(), detail::kMaxCircleSegments);
+        auto quarter = segment_count / 4;
+
+        // The center and a quarter of the circle for each corner, including both of the quarter's ends
+        std::array<Vertex, detail::kMaxCircleSegments + 5> vertices;
+        std::array<Index, (detail::kMaxCircleSegments + 4) * 3> indices;
+
+        vertices[0] = {{rect.x + rect.width * 0.5f, rect.y + rect.height * 0.5f}, {}, color};
+        // Clockwise from the bottom right corner, as the unit circle starts at the angle 0
+        Point const corner_centers[] = {
+                {get_x2(rect) - radius, get_y2(rect) - radius},
+                {rect.x + radius,       get_y2(rect) - radius},
+                {rect.x + radius,       rect.y + radius},
+                {get_x2(rect) - radius, rect.y + radius},
+        };
+        std::size_t vertex_count = 1;
+        for (std::size_t corner = 0; corner < 4; ++corner) {
+            for (std::size_t i = 0; i <= quarter; ++i) {
+                const auto& point = unit_circle[(corner * quarter + i) % segment_count];
+                const auto& corner_center = corner_centers[corner];
+                vertices[vertex_count++] = {{corner_center.x + point.x * radius, corner_center.y + point.y * radius},
+                                            {}, color};
+            }
+        }
+
+        auto rim_count = vertex_count - 1;
+        for (std::size_t i = 0; i < rim_count; ++i) {
+            indices[i * 3] = 0;
+            indices[i * 3 + 1] = static_cast<Index>(i + 1);
+            indices[i * 3 + 2] = static_cast<Index>((i + 1) % rim_count + 1);
+        }
+        add_triangles(vertices.data(), vertex_count, indices.data(), rim_count * 3);
+    }
+
+    void DrawList::add_polyline(const Point* points, std::size_t point_count, const Point& offset,
+                                float thickness, float fringe_width, const Color& color) {
+        if (point_count < 2) return;
+
+        // Lines thinner than the fringe fade out, instead of getting thinner
+        auto half_core = math::max(thickness - fringe_width, 0.0f) * 0.5f;
+        auto half_width = half_core + fringe_width;
+        Color core_color = color;
+        if (thickness < fringe_width) {
+            core_color.alpha = static_cast<uint8_t>(color.alpha * math::max(thickness / fringe_width, 0.0f));
+        }
+        Color fringe_color = color;
+        fringe_color.alpha = 0;
+
+        auto get_normal = [](const Point& from, const Point& to, const Point& fallback) {
+            auto dx = to.x - from.x;
+            auto dy = to.y - from.y;
+            auto length_squared = dx * dx + dy * dy;
+            if (length_squared <= 0.0f) return fallback;
+            auto inverse_length = 1.0f / std::sqrt(length_squared);
+            return Point{-dy * inverse_length, dx * inverse_length};
+        };
+
+        // Each point gets a cross section of 4 vertices: the fringe, the core's two edges and the other fringe
+        std::array<Vertex, 4> current;
+        Point segment_normal = get_normal(points[0], points[1], {0.0f, 1.0f});
+        auto make_cross_section = [&](std::size_t i) {
+            // The joint's normal is the average of the segments' normals, lengthened to keep the width at corners
+            auto next_normal = i + 1 < point_count ? get_normal(points[i], points[i + 1], segment_normal)
+                                                   : segment_normal;
+            Point normal{(segment_normal.x + next_normal.x) * 0.5f, (segment_normal.y + next_normal.y) * 0.5f};
+            auto miter_scale = 1.0f / math::max(normal.x * normal.x + normal.y * normal.y, 0.25f);
+            normal = {normal.x * miter_scale, normal.y * miter_scale};
+            segment_normal = next_normal;
+
+            Point point{points[i].x + offset.x, points[i].y + offset.y};
+            current[0] = {{point.x + normal.x * half_width, point.y + normal.y * half_width}, {}, fringe_color};
+            current[1] = {{point.x + normal.x * half_core,  point.y + normal.y * half_core},  {}, core_color};
+            current[2] = {{point.x - normal.x * half_core,  point.y - normal.y * half_core},  {}, core_color};
+            current[3] = {{point.x - normal.x * half_width, point.y - normal.y * half_width}, {}, fringe_color};
+        };
+        auto get_bounds = [](const std::array<Vertex, 4>& from, const std::array<Vertex, 4>& to) {
+            auto min_x = math::min(math::min(from[0].position.x, from[3].position.x),
+                                   math::min(to[0].position.x, to[3].position.x));
+            auto min_y = math::min(math::min(from[0].position.y, from[3].position.y),
+                                   math::min(to[0].position.y, to[3].position.y));
+            auto max_x = math::max(math::max(from[0].position.x, from[3].position.x),
+                                   math::max(to[0].position.x, to[3].position.x));
+            auto max_y = math::max(math::max(from[0].position.y, from[3].position.y),
+                                   math::max(to[0].position.y, to[3].position.y));
+            return Rectangle{min_x, min_y, max_x - min_x, max_y - min_y};
+        };
+
+        // Reserved up front, so a long strip doesn't reallocate the buffers while growing
+        auto segment_count = point_count - 1;
+        reserve_geometry(has_indices() ? point_count * 4 : segment_count * 12, has_indices() ? segment_count * 18 : 0);
+
+        make_cross_section(0);
+        if (!has_indices()) {
+            // Three quads across each segment: the fringe, the core and the other fringe
+            for (std::size_t i = 1; i < point_count; ++i) {
+                auto previous = current;
+                make_cross_section(i);
+
+                auto& command = prepare_vertex_command(12);
+                add_to_bounds(command, get_bounds(previous, current));
+                for (std::size_t strip = 0; strip < 3; ++strip) {
+                    push_vertex(previous[strip]);
+                    push_vertex(previous[strip + 1]);
+                    push_vertex(current[strip + 1]);
+                    push_vertex(current[strip]);
+                }
+                command.vertex_count += 12;
+                command.index_count += 18;
+            }
+            return;
+        }
+
+        // The cross sections share the vertices, the strip is cut into as few commands as the index type allows.
+        // A command after a cut starts with a copy of the last cross section
+        std::size_t next_point = 1;
+        while (next_point < point_count) {
+            auto& command = prepare_vertex_command(8);
+            auto section_count = math::min((max_command_vertices() - command.vertex_count) / 4,
+                                           point_count - next_point + 1);
+
+            // Sized once for the whole chunk without zeroing and written in place, so the loop has no capacity checks
+            auto first_vertex = vertex_count();
+            resize_vertices(first_vertex + section_count * 4);
+            auto first_index = _indices.size();
+            _indices.resize(first_index + (section_count - 1) * 18);
+            auto* index = _indices.data() + first_index;
+
+            auto base = static_cast<Index>(command.vertex_count);
+            auto min_x = math::min(current[0].position.x, current[3].position.x);
+            auto min_y = math::min(current[0].position.y, current[3].position.y);
+            auto max_x = math::max(current[0].position.x, current[3].position.x);
+            auto max_y = math::max(current[0].position.y, current[3].position.y);
+            // Instantiated for each of the vertex streams, so the hot loop doesn't branch on them
+            auto write_chunk = [&](auto write_vertex) {
+                for (std::size_t i = 0; i < 4; ++i) {
+                    write_vertex(first_vertex + i, current[i]);
+                }
+                for (std::size_t section = 1; section < section_count; ++section, ++next_point) {
+                    make_cross_section(next_point);
+                    for (std::size_t i = 0; i < 4; ++i) {
+                        write_vertex(first_vertex + section * 4 + i, current[i]);
+                    }
+                    for (auto* fringe : {&current[0], &current[3]}) {
+                        min_x = math::min(min_x, fringe->position.x);
+                        min_y = math::min(min_y, fringe->position.y);
+                        max_x = math::max(max_x, fringe->position.x);
+                        max_y = math::max(max_y, fringe->position.y);
+                    }
+
+                    auto next = static_cast<Index>(base + 4);
+                    for (Index strip = 0; strip < 3; ++strip) {
+                        index[0] = static_cast<Index>(base + strip);
+                        index[1] = static_cast<Index>(base + strip + 1);
+                        index[2] = static_cast<Index>(next + strip + 1);
+                        index[3] = static_cast<Index>(next + strip + 1);
+                        index[4] = static_cast<Index>(next + strip);
+                        index[5] = static_cast<Index>(base + strip);
+                        index += 6;
+                    }
+                    base = next;
+                }
+            };
+            if (_vertex_streams == VertexStreams::kSeparate) {
+                auto* positions = _positions.data();
+                auto* tex_coords = _tex_coords.data();
+                auto* colors = _colors.data();
+                write_chunk([positions, tex_coords, colors](std::size_t i, const Vertex& vertex) {
+                    positions[i] = vertex.position;
+                    tex_coords[i] = vertex.texCoord;
+                    colors[i] = vertex.color;
+                });
+            } else {
+                auto* vertices = _vertices.data();
+                write_chunk([vertices](std::size_t i, const Vertex& vertex) {
+                    vertices[i] = VertexLayout::make(vertex);
+                });
+            }
+            add_to_bounds(command, Rectangle{min_x, min_y, max_x - min_x, max_y - min_y});
+            command.vertex_count += static_cast<uint32_t>(section_count * 4);
+            command.index_count += static_cast<uint32_t>((section_count - 1) * 18);
+        }
+    }
+
+    void DrawList::add_gradient_rect(const Rectangle& rect, const Color& top_left, const Color& top_right,
+                                     const Color& bottom_right, const Color& bottom_left) {
+        add_quad({{rect.x,       rect.y},       {}, top_left},
+                 {{get_x2(rect), rect.y},       {}, top_right},
+                 {{get_x2(rect), get_y2(rect)}, {}, bottom_right},
+                 {{rect.x,       get_y2(rect)}, {}, bottom_left});
+    }
+}
\ No newline at end of file
@@ -0,0 +1,463 @@
+#ifndef REIG_DRAW_LIST_H
+#define REIG_DRAW_LIST_H
+
+#include "context_fwd.h"
+#include "primitive.h"
+#include "vertex_layout.h"
+#include <memory_resource>
+#include <vector>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <cstdint>
+#include <limits>
+
+namespace reig::detail {
+    /**
+     * @class UninitializedAllocator
+     * @brief A polymorphic allocator, that leaves plain data uninitialized when a vector grows by resize
+     * Meant for buffers, that are sized first and written in place right after
+     */
+    template <typename T>
+    class UninitializedAllocator : public std::pmr::polymorphic_allocator<T> {
+    public:
+        template <typename U>
+        struct rebind {
+            using other = UninitializedAllocator<U>;
+        };
+
+        using std::pmr::polymorphic_allocator<T>::polymorphic_allocator;
+
+        UninitializedAllocator() noexcept = default;
+
+        template <typename U>
+        UninitializedAllocator(const UninitializedAllocator<U>& other) noexcept
+                : std::pmr::polymorphic_allocator<T>{other.resource()} {}
+
+        template <typename U>
+        void construct(U* pointer) noexcept(std::is_nothrow_default_constructible_v<U>) {
+            // The vector's storage already holds such objects implicitly, the default member initializers are skipped
+            if constexpr (!std::is_trivially_copyable_v<U> || !std::is_trivially_destructible_v<U>) {
+                ::new(static_cast<void*>(pointer)) U;
+            }
+        }
+
+        template <typename U, typename... Args>
+        void construct(U* pointer, Args&& ... args) {
+            std::pmr::polymorphic_allocator<T>::construct(pointer, std::forward<Args>(args)...);
+        }
+
+        UninitializedAllocator select_on_container_copy_construction() const {
+            return {};
+        }
+    };
+}
+
+namespace reig::primitive {
+#ifdef REIG_16BIT_INDICES
+    using Index = uint16_t;
+#else
+    using Index = uint32_t;
+#endif
+
+    /**
+     * The most vertices a command can address, a command is split before its indices would overflow
+     */
+    constexpr std::size_t kMaxCommandVertices = std::size_t{std::numeric_limits<Index>::max()} + 1;
+
+    /**
+     * The clip rectangle of commands, that are not clipped
+     */
+    constexpr Rectangle kUnclippedRect{-16777216.0f, -16777216.0f, 33554432.0f, 33554432.0f};
+
+    /**
+     * The most vertices a command can have in a quad list, so the shared quad indices stay small
+     */
+    constexpr std::size_t kMaxQuadListVertices = kMaxCommandVertices < 65536u ? kMaxCommandVertices : 65536u;
+
+    enum class GeometryOutput {
+        /**
+         * Every command has its own indices in the DrawList's index array
+         */
+        kIndexed,
+        /**
+         * All the geometry is quads of 4 vertices, the DrawList holds no indices.
+         * Commands are drawn with the shared indices from get_quad_list_indices, their index_offset is always 0
+         */
+        kQuadList,
+        /**
+         * Rectangles and glyphs are stored as one QuadInstance each, to be expanded by the GPU.
+         * Any other geometry is stored as indexed vertices, in separate commands
+         */
+        kInstanced,
+    };
+
+    enum class VertexStreams {
+        /**
+         * The vertices are stored in the compile-time selected VertexLayout
+         */
+        kInterleaved,
+        /**
+         * Positions, texture coordinates and colors are stored in three separate arrays, with float coordinates.
+         * Meant for consumers, that process the vertices on the CPU in batches
+         */
+        kSeparate,
+    };
+
+    /**
+     * @brief A textured and colored rectangle, that a backend draws as one instance of a quad
+     * Texture coordinates are normalized to the full range of uint16_t
+     */
+    struct QuadInstance {
+        Rectangle rect;
+        uint16_t u0 = 0;
+        uint16_t v0 = 0;
+        uint16_t u1 = 0;
+        uint16_t v1 = 0;
+        Color color;
+        int32_t texture_id = 0;
+    };
+
+    static_assert(sizeof(QuadInstance) == 32, "QuadInstance is expected to be packed");
+
+    /**
+     * @brief The buffer of vertices or indices, its new elements are left uninitialized by resize
+     */
+    template <typename T>
+    using GeometryBuffer = std::vector<T, detail::UninitializedAllocator<T>>;
+
+    /**
+     * @brief Returns the indices {0, 1, 2, 2, 3, 0}, shifted by 4 for every next quad, for the largest possible command
+     * Meant to be uploaded once by the backends using GeometryOutput::kQuadList
+     */
+    const std::vector<Index>& get_quad_list_indices();
+
+    /**
+     * @brief How many commands the culling dropped, by the reason
+     */
+    struct CullStatistics {
+        /**
+         * Untextured commands, that have a fully transparent color
+         */
+        std::size_t transparent = 0;
+        /**
+         * Commands without any area, e.g. of rectangles shrunk to nothing
+         */
+        std::size_t degenerate = 0;
+        /**
+         * Commands wholly outside of their clip rectangle
+         */
+        std::size_t clipped = 0;
+        /**
+         * Commands covered by an opaque rectangle, that is drawn later in the same layer
+         */
+        std::size_t occluded = 0;
+    };
+
+    struct DrawCommand;
+
+    /**
+     * @return The command's bounds, mapped to the screen by the command's transform
+     */
+    Rectangle get_screen_bounds(const DrawCommand& command);
+
+    /**
+     * @brief A range of a DrawList's buffers, that is drawn with a single texture
+     * Indices of the command are relative to its vertex_offset.
+     * A command holds either vertices or instances, the instanced ones have a non zero instance_count.
+     * Positions, bounds and the clip rectangle are in the command's space, transform maps them to the screen
+     */
+    struct DrawCommand {
+        /**
+         * The rectangle enclosing all the command's vertices
+         */
+        Rectangle bounds;
+        /**
+         * The area outside of which the command must not draw, meant for scissor tests
+         */
+        Rectangle clip_rect = kUnclippedRect;
+        /**
+         * Maps the command's positions to the screen, e.g. to the origin of its window or a zoomed canvas
+         */
+        Transform transform;
+        int texture_id = 0;
+        uint32_t vertex_offset = 0;
+        uint32_t vertex_count = 0;
+        uint32_t index_offset = 0;
+        uint32_t index_count = 0;
+        uint32_t instance_offset = 0;
+        uint32_t instance_count = 0;
+    };
+
+    /**
+     * @class DrawList
+     * @brief All the geometry of a layer, packed into flat buffers
+     * Every command shares the same vertex and index arrays, so a backend can upload each of them in one call
+     * Can be collected by the user, but formation is accessible only for the Context
+     */
+    class DrawList {
+    public:
+        /**
+         * @param resource The memory resource used for all the buffers
+         */
+        explicit DrawList(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        /**
+         * @brief Returns the vertices of all the commands, in the compile-time selected VertexLayout
+         * Empty if VertexStreams::kSeparate is used
+         */
+        const GeometryBuffer<DrawVertex>& vertices() const;
+
+        /**
+         * @brief Returns the vertex positions of all the commands, empty unless VertexStreams::kSeparate is used
+         */
+        const GeometryBuffer<Point>& positions() const;
+
+        /**
+         * @brief Returns the vertex texture coordinates of all the commands,
+         * empty unless VertexStreams::kSeparate is used
+         */
+        const GeometryBuffer<Point>& tex_coords() const;
+
+        /**
+         * @brief Returns the vertex colors of all the commands, empty unless VertexStreams::kSeparate is used
+         */
+        const GeometryBuffer<Color>& colors() const;
+
+        /**
+         * @brief Returns the indices of all the commands
+         */
+        const GeometryBuffer<Index>& indices() const;
+
+        /**
+         * @brief Returns the commands, in the order they have to be drawn
+         */
+        const std::pmr::vector<DrawCommand>& commands() const;
+
+        /**
+         * @brief Returns the instances of all the instanced commands, empty unless GeometryOutput::kInstanced is used
+         */
+        const std::pmr::vector<QuadInstance>& instances() const;
+
+        bool empty() const;
+
+        GeometryOutput geometry_output() const;
+
+        VertexStreams vertex_streams() const;
+
+        /**
+         * @brief Returns a hash of all the commands and their geometry, as they are passed to the render handler
+         * Zero unless Config::change_tracking is enabled
+         */
+        std::uint64_t content_hash() const;
+
+        /**
+         * @brief Returns true if the layer is the same as in the last frame,
+         * so a backend can reuse whatever it made of it, e.g. the uploaded buffers.
+         * Always false unless Config::change_tracking is enabled
+         */
+        bool is_unchanged() const;
+
+    private:
+        friend class ::reig::Context;
+
+        /**
+         * @brief Removes the geometry, remembering its size to reserve the buffers next time
+         */
+        void clear();
+
+        /**
+         * @brief Drops the buffers, to be called before the memory resource is reset
+         */
+        void release();
+
+        /**
+         * @brief Replaces the geometry with a copy of the other list's, keeping this list's memory resource
+         */
+        void assign(const DrawList& other);
+
+        /**
+         * @brief Appends copies of all the other list's commands and their geometry, which must have the same output
+         */
+        void append(const DrawList& other);
+
+        void set_geometry_output(GeometryOutput geometry_output);
+
+        void set_vertex_streams(VertexStreams vertex_streams);
+
+        /**
+         * @brief Hashes the buffers, to be called once the layer is final
+         * @param previous_hash The layer's hash in the last frame
+         */
+        void update_content_hash(std::uint64_t previous_hash);
+
+        /**
+         * @return The number of vertices in whichever of the streams is used
+         */
+        std::size_t vertex_count() const;
+
+        std::size_t max_command_vertices() const;
+
+        /**
+         * @return True if the vertex commands have their own indices
+         */
+        bool has_indices() const;
+
+        bool can_merge(const DrawCommand& left, const DrawCommand& right) const;
+
+        /**
+         * @brief Moves commands into runs of the same texture, keeping the order of overlapping commands
+         * A command is moved back to the latest command with its texture, unless it overlaps anything in between
+         */
+        void reorder_commands();
+
+        /**
+         * @brief Joins adjacent commands, that can be drawn in a single call, rebasing their indices
+         * @return The number of commands left
+         */
+        std::size_t merge_commands();
+
+        /**
+         * @brief Drops the commands, that can't be seen, and closes the gaps they leave in the buffers
+         * Meant to run before the batching, while most commands are still a single figure.
+         * Only single opaque untextured rectangles are taken as occluders
+         * @param statistics Increased by the number of the dropped commands
+         */
+        void cull_commands(CullStatistics& statistics);
+
+        /**
+         * @return True if the command is untextured and all of its colors are fully transparent
+         */
+        bool is_transparent(const DrawCommand& command) const;
+
+        /**
+         * @brief Finds the screen area, which the command covers completely
+         * @return False unless the command is a single untextured axis aligned rectangle, with an opaque color
+         */
+        bool get_opaque_rect(const DrawCommand& command, Rectangle& opaque_rect) const;
+
+        /**
+         * @brief Narrows the clip rectangles of all the commands
+         * @param clip_rect The rectangle in screen space
+         */
+        void clip_commands(const Rectangle& clip_rect);
+
+        /**
+         * @brief Moves all the commands on the screen by the offset, without touching the vertices
+         */
+        void translate_commands(const Point& offset);
+
+        /**
+         * @brief Starts a new command, to which the following geometry is appended
+         */
+        void start_command(int texture_id, const Rectangle& clip_rect = kUnclippedRect,
+                           const Transform& transform = {});
+
+        /**
+         * @brief Continues the current command's texture in a new command,
+         * when the current one is full or holds another kind of geometry
+         */
+        void split_command();
+
+        /**
+         * @brief Appends an axis aligned rectangle, as an instance or as a quad depending on the GeometryOutput
+         * @param tex_rect The texture coordinates of the top left corner and the size of the texture area
+         */
+        void add_rect(const Rectangle& rect, const Rectangle& tex_rect, const Color& color);
+
+        /**
+         * @brief Appends a quad to the current command, the vertices are expected in clockwise order
+         * The vertices are converted to the VertexLayout here
+         */
+        void add_quad(const Vertex& v0, const Vertex& v1, const Vertex& v2, const Vertex& v3);
+
+        /**
+         * @brief Appends an indexed triangle list to the current command
+         * The indices are relative to the first of the vertices, all of which have to fit into a single command
+         */
+        void add_triangles(const Vertex* vertices, std::size_t vertex_count,
+                           const Index* indices, std::size_t index_count);
+
+        /**
+         * @brief Appends a filled rectangle with a border inside of its edges,
+         * as an 8 vertex ring and a fill when the geometry is indexed
+         * @param is_border_under_fill Whether a translucent fill is blended over the border color, as if the fill
+         * was drawn over a rectangle of the border color, or over whatever is behind the rectangle
+         */
+        void add_bordered_rect(const Rectangle& rect, float border_thickness,
+                               const Color& fill_color, const Color& border_color, bool is_border_under_fill);
+
+        /**
+         * @brief Appends a rectangle, with the colors interpolated between its corners
+         */
+        void add_gradient_rect(const Rectangle& rect, const Color& top_left, const Color& top_right,
+                               const Color& bottom_right, const Color& bottom_left);
+
+        /**
+         * @brief Appends a circle, as a fan around its center
+         * @param unit_circle The points of the circle's outline, scaled by the radius
+         */
+        void add_circle(const Point& center, float radius, const std::vector<Point>& unit_circle, const Color& color);
+
+        /**
+         * @brief Appends a rectangle with rounded corners, as a fan around its center
+         * @param radius The radius of the corners, clamped to half of the rect's smaller side
+         * @param unit_circle The points of a whole circle, of which the quarters make the corners
+         */
+        void add_rounded_rect(const Rectangle& rect, float radius, const std::vector<Point>& unit_circle,
+                              const Color& color);
+
+        /**
+         * @brief Appends an anti-aliased strip through the points, with an alpha fringe on both of its sides
+         * The strip stays in the current command, unless it doesn't fit into one
+         * @param offset Added to all of the points
+         * @param fringe_width The width of the fringe, in which the alpha falls to zero
+         */
+        void add_polyline(const Point* points, std::size_t point_count, const Point& offset,
+                          float thickness, float fringe_width, const Color& color);
+
+        /**
+         * @brief Returns the command, to which the vertices can be appended, splitting the current one if needed
+         */
+        DrawCommand& prepare_vertex_command(std::size_t vertex_count);
+
+        /**
+         * @brief Appends a vertex to the streams in use, without an index
+         */
+        void push_vertex(const Vertex& vertex);
+
+        /**
+         * @brief Resizes the vertex streams in use, the new vertices are left uninitialized to be written in place
+         */
+        void resize_vertices(std::size_t count);
+
+        /**
+         * @brief Makes room for the geometry, that is about to be appended
+         */
+        void reserve_geometry(std::size_t vertex_count, std::size_t index_count);
+
+        static void add_to_bounds(DrawCommand& command, const Rectangle& rect);
+
+        GeometryBuffer<DrawVertex> _vertices;
+        GeometryBuffer<Point> _positions;
+        GeometryBuffer<Point> _tex_coords;
+        GeometryBuffer<Color> _colors;
+        GeometryBuffer<Index> _indices;
+        std::pmr::vector<DrawCommand> _commands;
+        std::pmr::vector<QuadInstance> _instances;
+        GeometryOutput _geometry_output = GeometryOutput::kIndexed;
+        VertexStreams _vertex_streams = VertexStreams::kInterleaved;
+        std::size_t _expected_vertex_count = 0;
+        std::size_t _expected_index_count = 0;
+        std::size_t _expected_command_count = 0;
+        std::size_t _expected_instance_count = 0;
+        std::uint64_t _content_hash = 0;
+        bool _is_unchanged = false;
+    };
+}
+
+namespace reig {
+    using DrawData = primitive::DrawList;
+}
+
+#endif //REIG_DRAW_LIST_H
@@ -49,6 +49,10 @@ namespace reig::exception {
         return "No render handler specified";
     }
 
+    InvalidTransformException::InvalidTransformException(float scale)
+            : std::invalid_argument{"Transform scale must be positive, got " + std::to_string(scale)} {
+    }
+
     IntegralCastException::IntegralCastException(long long val, gsl::czstring src_type, gsl::czstring dest_type)
             : std::range_error{"Bad integral cast from "s + src_type + " (" + std::to_string(val) + ") to " + dest_type} {
     }
@@ -25,6 +25,10 @@ namespace reig::exception {
         gsl::czstring what() const noexcept override;
     };
 
+    struct InvalidTransformException : std::invalid_argument {
+        explicit InvalidTransformException(float scale);
+    };
+
     struct IntegralCastException : std::range_error {
         IntegralCastException(long long val, gsl::czstring src_type, gsl::czstring dest_type);
     };
@@ -0,0 +1,72 @@
+#include "frame_arena.h"
+#include "maths.h"
+#include <cstdint>
+
+namespace reig::detail {
+    FrameArena::FrameArena(std::size_t initial_size)
+            : _initial_size{initial_size} {}
+
+    void FrameArena::reset() {
+        _block_allocation_count = 0;
+        _offset = 0;
+        if (_blocks.size() > 1) {
+            std::size_t total_size = 0;
+            for (auto& block : _blocks) {
+                total_size += block.size;
+            }
+            _blocks.clear();
+            add_block(total_size);
+        }
+    }
+
+    std::size_t FrameArena::block_allocation_count() const {
+        return _block_allocation_count;
+    }
+
+    void FrameArena::add_block(std::size_t size) {
+        Block block;
+        block.memory = std::make_unique<std::byte[]>(size);
+        block.size = size;
+        _blocks.push_back(std::move(block));
+        _offset = 0;
+        ++_block_allocation_count;
+    }
+
+    inline std::size_t get_padding(const std::byte* ptr, std::size_t alignment) {
+        auto address = reinterpret_cast<std::uintptr_t>(ptr);
+        return (alignment - address % alignment) % alignment;
+    }
+
+    void* FrameArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+        if (!_blocks.empty()) {
+            auto& block = _blocks.back();
+            auto* top = block.memory.get() + _offset;
+            auto padding = get_padding(top, alignment);
+            if (_offset + padding + bytes <= block.size) {
+                _offset += padding + bytes;
+                return top + padding;
+            }
+        }
+
+        auto last_size = _blocks.empty() ? _initial_size : _blocks.back().size * 2;
+        add_block(math::max(last_size, bytes + alignment));
+
+        auto* top = _blocks.back().memory.get();
+        auto padding = get_padding(top, alignment);
+        _offset = padding + bytes;
+        return top + padding;
+    }
+
+    void FrameArena::do_deallocate(void* ptr, std::size_t bytes, std::size_t) {
+        // Only the latest allocation can be given back, which is common for temporary buffers
+        if (_blocks.empty()) return;
+        auto* top = _blocks.back().memory.get() + _offset;
+        if (static_cast<std::byte*>(ptr) + bytes == top) {
+            _offset -= bytes;
+        }
+    }
+
+    bool FrameArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+        return this == &other;
+    }
+}
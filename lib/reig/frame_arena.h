@@ -0,0 +1,61 @@
+#ifndef REIG_FRAME_ARENA_H
+#define REIG_FRAME_ARENA_H
+
+#include <memory_resource>
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+namespace reig::detail {
+    /**
+     * @class FrameArena
+     * @brief A bump allocator for data, that lives no longer than a frame
+     * Deallocation only gives back the latest allocation, e.g. a temporary buffer, the rest of the memory
+     * is reclaimed at once by reset.
+     * Memory is kept between frames, so after a warm-up the heap is not touched anymore
+     */
+    class FrameArena : public std::pmr::memory_resource {
+    public:
+        explicit FrameArena(std::size_t initial_size = 64u * 1024u);
+
+        FrameArena(const FrameArena&) = delete;
+
+        FrameArena(FrameArena&&) = delete;
+
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        FrameArena& operator=(FrameArena&&) = delete;
+
+        /**
+         * @brief Makes all of the memory available again. Everything allocated before is invalidated
+         * If the last frame did not fit in one block, the blocks are merged into a bigger one
+         */
+        void reset();
+
+        /**
+         * @return How many blocks the arena allocated from the heap since the last reset
+         */
+        std::size_t block_allocation_count() const;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        void add_block(std::size_t size);
+
+        struct Block {
+            std::unique_ptr<std::byte[]> memory;
+            std::size_t size = 0;
+        };
+
+        std::vector<Block> _blocks;
+        std::size_t _offset = 0;
+        std::size_t _initial_size = 0;
+        std::size_t _block_allocation_count = 0;
+    };
+}
+
+#endif //REIG_FRAME_ARENA_H
@@ -0,0 +1,82 @@
+#include "frame_ring.h"
+
+namespace reig::detail {
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The frame ring's slots must be lock-free");
+
+    FrameRing::FrameRing(std::size_t slot_count)
+            : _slots{std::make_unique<std::atomic<std::uint64_t>[]>(slot_count)},
+              _slot_count{slot_count} {
+        for (std::size_t i = 0; i < _slot_count; ++i) {
+            _slots[i].store(pack_slot(0, kFree), std::memory_order_relaxed);
+        }
+    }
+
+    std::size_t FrameRing::slot_count() const {
+        return _slot_count;
+    }
+
+    std::uint64_t FrameRing::pack_slot(std::uint64_t sequence, SlotState state) {
+        return (sequence << 2u) | state;
+    }
+
+    std::size_t FrameRing::begin_write(bool& is_replacing) {
+        while (true) {
+            std::size_t newest_slot = kNoSlot;
+            std::uint64_t newest_value = 0;
+            for (std::size_t i = 0; i < _slot_count; ++i) {
+                // Acquired, so that the reader is done with a slot it has freed
+                auto value = _slots[i].load(std::memory_order_acquire);
+                auto state = value & kStateMask;
+                if (state == kFree) {
+                    // Only the writer takes free slots
+                    _slots[i].store(pack_slot(value >> 2u, kWriting), std::memory_order_relaxed);
+                    is_replacing = false;
+                    return i;
+                }
+                // The states are the same, so the packed values compare by the sequence
+                if (state == kPublished && (newest_slot == kNoSlot || value > newest_value)) {
+                    newest_slot = i;
+                    newest_value = value;
+                }
+            }
+
+            // The reader holds at most one slot, so with two or more some frame was published, unless it took it
+            if (newest_slot != kNoSlot
+                && _slots[newest_slot].compare_exchange_strong(newest_value, pack_slot(newest_value >> 2u, kWriting),
+                                                               std::memory_order_acquire)) {
+                is_replacing = true;
+                return newest_slot;
+            }
+        }
+    }
+
+    void FrameRing::publish(std::size_t slot) {
+        _slots[slot].store(pack_slot(++_next_sequence, kPublished), std::memory_order_release);
+    }
+
+    std::size_t FrameRing::acquire() {
+        while (true) {
+            std::size_t oldest_slot = kNoSlot;
+            std::uint64_t oldest_value = 0;
+            for (std::size_t i = 0; i < _slot_count; ++i) {
+                auto value = _slots[i].load(std::memory_order_relaxed);
+                if ((value & kStateMask) == kPublished && (oldest_slot == kNoSlot || value < oldest_value)) {
+                    oldest_slot = i;
+                    oldest_value = value;
+                }
+            }
+            if (oldest_slot == kNoSlot) return kNoSlot;
+
+            // Fails if the writer took the frame back in the meantime, to replace it
+            if (_slots[oldest_slot].compare_exchange_strong(oldest_value, pack_slot(oldest_value >> 2u, kReading),
+                                                            std::memory_order_acquire)) {
+                return oldest_slot;
+            }
+        }
+    }
+
+    void FrameRing::release(std::size_t slot) {
+        auto sequence = _slots[slot].load(std::memory_order_relaxed) >> 2u;
+        _slots[slot].store(pack_slot(sequence, kFree), std::memory_order_release);
+    }
+}
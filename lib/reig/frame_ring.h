@@ -0,0 +1,74 @@
+#ifndef REIG_FRAME_RING_H
+#define REIG_FRAME_RING_H
+
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+
+namespace reig::detail {
+    /**
+     * @class FrameRing
+     * @brief Hands out the slots of a ring of frames, between one thread writing them and one thread reading them
+     * The slots' data is kept by the user, the ring only tracks which thread may touch which slot.
+     * Every operation is a few atomic loads and compare-exchanges, neither of the threads ever waits for the other
+     */
+    class FrameRing {
+    public:
+        static constexpr std::size_t kNoSlot = std::numeric_limits<std::size_t>::max();
+
+        /**
+         * @param slot_count The number of slots, at least 2 if any, so that the writer always finds one
+         */
+        explicit FrameRing(std::size_t slot_count = 0);
+
+        std::size_t slot_count() const;
+
+        /**
+         * @brief Takes a slot to write the next frame into, called by the writer
+         * A free slot is taken if there is one, otherwise the newest published frame, which wasn't read in time.
+         * The older frames stay queued, so each frame the reader gets follows the one it got before
+         * @param is_replacing Set to true if a published frame was taken back, its data is still in the slot
+         */
+        std::size_t begin_write(bool& is_replacing);
+
+        /**
+         * @brief Makes the written slot available to the reader, as the newest frame
+         */
+        void publish(std::size_t slot);
+
+        /**
+         * @brief Takes the oldest published frame, called by the reader
+         * @return The frame's slot, kNoSlot if no frame was published since the last one was taken
+         */
+        std::size_t acquire();
+
+        /**
+         * @brief Gives back the read slot, so that the writer may reuse it
+         */
+        void release(std::size_t slot);
+
+    private:
+        /**
+         * The state is packed with the frame's sequence number, so that a slot taken and published again in between
+         * fails the reader's compare-exchange, instead of passing a newer frame before an older one
+         */
+        enum SlotState : std::uint64_t {
+            kFree = 0,
+            kWriting = 1,
+            kPublished = 2,
+            kReading = 3,
+        };
+
+        static constexpr std::uint64_t kStateMask = 3u;
+
+        static std::uint64_t pack_slot(std::uint64_t sequence, SlotState state);
+
+        std::unique_ptr<std::atomic<std::uint64_t>[]> _slots;
+        std::size_t _slot_count = 0;
+        std::uint64_t _next_sequence = 0;
+    };
+}
+
+#endif //REIG_FRAME_RING_H
@@ -0,0 +1,47 @@
+#include "hash.h"
+#include <cstring>
+
+namespace reig::detail {
+    std::uint64_t hash_bytes(const void* data, std::size_t size, std::uint64_t hash) {
+        std::uint64_t const multiplier = 0x9e3779b97f4a7c15u;
+        auto mix = [multiplier](std::uint64_t& lane, std::uint64_t word) {
+            lane = (lane ^ word) * multiplier;
+            lane ^= lane >> 32;
+        };
+
+        auto* bytes = static_cast<const unsigned char*>(data);
+        std::size_t i = 0;
+        // The lanes don't depend on each other, so their multiplications overlap instead of waiting one for another
+        constexpr std::size_t lane_count = 8;
+        constexpr std::size_t block_size = lane_count * sizeof(std::uint64_t);
+        if (size >= block_size) {
+            std::uint64_t lanes[lane_count];
+            for (std::size_t lane = 0; lane < lane_count; ++lane) {
+                lanes[lane] = hash + lane;
+            }
+            for (; i + block_size <= size; i += block_size) {
+                for (std::size_t lane = 0; lane < lane_count; ++lane) {
+                    std::uint64_t word;
+                    std::memcpy(&word, bytes + i + lane * sizeof(word), sizeof(word));
+                    mix(lanes[lane], word);
+                }
+            }
+            hash = lanes[0];
+            for (std::size_t lane = 1; lane < lane_count; ++lane) {
+                mix(hash, lanes[lane]);
+            }
+        }
+        for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+            std::uint64_t word;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            mix(hash, word);
+        }
+        if (i < size) {
+            std::uint64_t tail = 0;
+            std::memcpy(&tail, bytes + i, size - i);
+            mix(hash, tail);
+        }
+        mix(hash, size);
+        return hash;
+    }
+}
@@ -0,0 +1,15 @@
+#ifndef REIG_HASH_H
+#define REIG_HASH_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace reig::detail {
+    /**
+     * @brief Mixes the bytes into the hash, eight at a time
+     * Meant for telling whether data changed between frames, not for resisting deliberate collisions
+     */
+    std::uint64_t hash_bytes(const void* data, std::size_t size, std::uint64_t hash = 0);
+}
+
+#endif //REIG_HASH_H
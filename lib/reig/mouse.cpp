@@ -33,7 +33,8 @@ namespace reig::detail {
 
     bool Mouse::is_hovering_over_rect(const Rectangle& rect) const {
         bool hovering_over_rect = !_context._dragged_window
-                                  && is_point_in_rect(_cursor_pos, rect);
+                                  && is_point_in_rect(_context.to_widget_space(_cursor_pos), rect)
+                                  && is_point_in_rect(_cursor_pos, _context.get_clip_rect());
         if (!hovering_over_rect) return false;
 
         bool is_hovered_point_visible = _context.is_window_body_point_visible(_cursor_pos);
@@ -69,7 +70,8 @@ namespace reig::detail {
 
     bool MouseButton::clicked_in_rect(const primitive::Rectangle& rect) const {
         bool clicked_in_rect = !_mouse._context._dragged_window
-                               && is_point_in_rect(_clicked_pos, rect);
+                               && is_point_in_rect(_mouse._context.to_widget_space(_clicked_pos), rect)
+                               && is_point_in_rect(_clicked_pos, _mouse._context.get_clip_rect());
         if (!clicked_in_rect) return false;
 
         bool is_clicked_point_visible = _mouse._context.is_window_body_point_visible(_clicked_pos);
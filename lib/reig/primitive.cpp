@@ -1,8 +1,6 @@
 #include "primitive.h"
 #include "maths.h"
 
-using std::vector;
-
 namespace reig::primitive {
     bool is_point_in_rect(const Point& pt, const Rectangle& rect) {
         return math::is_between(pt.x, rect.x, get_x2(rect)) && math::is_between(pt.y, rect.y, get_y2(rect));
@@ -34,6 +32,54 @@ namespace reig::primitive {
         fit_size(fitted.height, fitted.y, container.height, container.y);
     }
 
+    bool is_rect_overlapping(const Rectangle& rect, const Rectangle& other) {
+        return rect.x < get_x2(other) && other.x < get_x2(rect)
+               && rect.y < get_y2(other) && other.y < get_y2(rect);
+    }
+
+    Rectangle get_bounding_rect(const Rectangle& rect, const Rectangle& other) {
+        auto x = math::min(rect.x, other.x);
+        auto y = math::min(rect.y, other.y);
+        return {x, y, math::max(get_x2(rect), get_x2(other)) - x, math::max(get_y2(rect), get_y2(other)) - y};
+    }
+
+    Rectangle get_overlapping_rect(const Rectangle& rect, const Rectangle& other) {
+        auto x = math::max(rect.x, other.x);
+        auto y = math::max(rect.y, other.y);
+        return {x, y,
+                math::max(math::min(get_x2(rect), get_x2(other)) - x, 0.0f),
+                math::max(math::min(get_y2(rect), get_y2(other)) - y, 0.0f)};
+    }
+
+    bool is_rect_in_rect(const Rectangle& inner, const Rectangle& outer) {
+        return inner.x >= outer.x && inner.y >= outer.y
+               && get_x2(inner) <= get_x2(outer) && get_y2(inner) <= get_y2(outer);
+    }
+
+    Point transform_point(const Transform& transform, const Point& point) {
+        return {point.x * transform.scale + transform.translation.x,
+                point.y * transform.scale + transform.translation.y};
+    }
+
+    Point inverse_transform_point(const Transform& transform, const Point& point) {
+        return {(point.x - transform.translation.x) / transform.scale,
+                (point.y - transform.translation.y) / transform.scale};
+    }
+
+    Rectangle transform_rect(const Transform& transform, const Rectangle& rect) {
+        auto position = transform_point(transform, {rect.x, rect.y});
+        return {position.x, position.y, rect.width * transform.scale, rect.height * transform.scale};
+    }
+
+    Rectangle inverse_transform_rect(const Transform& transform, const Rectangle& rect) {
+        auto position = inverse_transform_point(transform, {rect.x, rect.y});
+        return {position.x, position.y, rect.width / transform.scale, rect.height / transform.scale};
+    }
+
+    Transform combine_transforms(const Transform& outer, const Transform& inner) {
+        return {transform_point(outer, inner.translation), outer.scale * inner.scale};
+    }
+
     std::array<Rectangle, 4> get_rect_frame(const Rectangle& rect, float thickness) {
         return {
                 Rectangle{rect.x,                          rect.y,                           rect.width, thickness},
@@ -83,22 +129,4 @@ namespace reig::primitive {
         color.blue > min + delta ? color.blue -= delta : color.blue = min;
         return color;
     }
-
-    void Figure::form(vector<Vertex>& vertices, vector<int>& indices, int id) {
-        vertices.swap(_vertices);
-        indices.swap(_indices);
-        _texture_id = id;
-    }
-
-    const vector<Vertex>& Figure::vertices() const {
-        return _vertices;
-    }
-
-    const vector<int>& Figure::indices() const {
-        return _indices;
-    }
-
-    int Figure::texture() const {
-        return _texture_id;
-    }
-}
+}
\ No newline at end of file
@@ -2,8 +2,9 @@
 #define REIG_PRIMITIVE_H
 
 #include "context_fwd.h"
-#include <vector>
 #include <array>
+#include <cstdint>
+#include <type_traits>
 
 namespace reig::primitive {
     struct Point {
@@ -28,12 +29,66 @@ namespace reig::primitive {
 
     bool is_point_in_rect(const Point& pt, const Rectangle& rect);
 
+    inline bool is_same_rect(const Rectangle& rect, const Rectangle& other) {
+        return rect.x == other.x && rect.y == other.y && rect.width == other.width && rect.height == other.height;
+    }
+
     Rectangle decrease_rect(Rectangle rect, int by);
 
+    inline Rectangle translate_rect(const Rectangle& rect, const Point& offset) {
+        return {rect.x + offset.x, rect.y + offset.y, rect.width, rect.height};
+    }
+
     std::array<Rectangle, 4> get_rect_frame(const Rectangle& rect, float thickness);
 
     void trim_rect_in_other(Rectangle& fitted, const Rectangle& container);
 
+    /**
+     * @return True if the rectangles share some area, touching edges are not considered overlapping
+     */
+    bool is_rect_overlapping(const Rectangle& rect, const Rectangle& other);
+
+    /**
+     * @return The smallest rectangle containing both of the rectangles
+     */
+    Rectangle get_bounding_rect(const Rectangle& rect, const Rectangle& other);
+
+    /**
+     * @return The area shared by both of the rectangles, it has no width or height if they don't overlap
+     */
+    Rectangle get_overlapping_rect(const Rectangle& rect, const Rectangle& other);
+
+    /**
+     * @return True if the inner rectangle lies wholly within the outer one, edges included
+     */
+    bool is_rect_in_rect(const Rectangle& inner, const Rectangle& outer);
+
+    /**
+     * @brief Scales uniformly and then translates
+     */
+    struct Transform {
+        Point translation;
+        float scale = 1.0f;
+    };
+
+    Point transform_point(const Transform& transform, const Point& point);
+
+    Point inverse_transform_point(const Transform& transform, const Point& point);
+
+    Rectangle transform_rect(const Transform& transform, const Rectangle& rect);
+
+    Rectangle inverse_transform_rect(const Transform& transform, const Rectangle& rect);
+
+    /**
+     * @return The transform applying the inner transform first and then the outer one
+     */
+    Transform combine_transforms(const Transform& outer, const Transform& inner);
+
+    inline bool is_same_transform(const Transform& transform, const Transform& other) {
+        return transform.translation.x == other.translation.x && transform.translation.y == other.translation.y
+               && transform.scale == other.scale;
+    }
+
     struct Triangle {
         Point pos0;
         Point pos1;
@@ -182,44 +237,6 @@ namespace reig::primitive {
         Point texCoord;
         Color color;
     };
-
-    /**
-     * @class Figure
-     * @brief A bunch of vertices and indices to render a figure
-     * Can be collected by the user, but formation is accessible only for the Context
-     */
-    class Figure {
-    public:
-        /**
-         * @brief Returns figure's read-only vertices
-         */
-        const std::vector<Vertex>& vertices() const;
-
-        /**
-         * @brief Returns figure's read-only indices
-         */
-        const std::vector<int>& indices() const;
-
-        /**
-         * @brief Return figure's texture index
-         */
-        int texture() const;
-
-    private:
-        Figure() = default;
-
-        friend class ::reig::Context;
-
-        void form(std::vector<Vertex>& vertices, std::vector<int>& indices, int id = 0);
-
-        std::vector<Vertex> _vertices;
-        std::vector<int> _indices;
-        int _texture_id = 0;
-    };
-}
-
-namespace reig {
-    using DrawData = std::vector<primitive::Figure>;
 }
 
 #endif //REIG_PRIMITIVE_H
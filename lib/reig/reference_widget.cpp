@@ -10,8 +10,12 @@ namespace reig::reference_widget {
         const bool is_holding_click = false;
     };
 
-    ButtonModel get_button_model(Context& ctx, Rectangle& bounding_box) {
-        ctx.fit_rect_in_window(bounding_box);
+    ButtonModel get_button_model(Context& ctx, Rectangle& bounding_box, const Rectangle& fitted_area) {
+        Rectangle fitted_box = bounding_box;
+        trim_rect_in_other(fitted_box, fitted_area);
+        ctx.fit_rect_in_window(fitted_box);
+        bounding_box.x = fitted_box.x;
+        bounding_box.y = fitted_box.y;
 
         bool is_hovering_over_area = ctx.mouse.is_hovering_over_rect(bounding_box);
         bool has_just_clicked = ctx.mouse.left_button.just_clicked_in_rect(bounding_box);
@@ -23,22 +27,27 @@ namespace reig::reference_widget {
     }
 
     bool button(Context& ctx, gsl::czstring title, Rectangle bounding_box, Color base_color) {
-        auto model = get_button_model(ctx, bounding_box);
+        return detail::button(ctx, title, bounding_box, bounding_box, base_color);
+    }
+
+    bool detail::button(Context& ctx, gsl::czstring title, Rectangle bounding_box, const Rectangle& fitted_area,
+                        Color base_color) {
+        auto model = get_button_model(ctx, bounding_box, fitted_area);
+        if (!ctx.is_rect_visible(bounding_box)) return model.has_just_clicked;
 
         Color inner_color{base_color};
         if (model.is_hovering_over_area) {
             inner_color = colors::lighten_color_by(inner_color, 30);
         }
-        Rectangle base_area;
+        int border_size = 4;
         if (model.is_holding_click) {
             inner_color = colors::lighten_color_by(inner_color, 30);
-            base_area = decrease_rect(bounding_box, 6);
-        } else {
-            base_area = decrease_rect(bounding_box, 4);
+            border_size = 6;
         }
+        Rectangle base_area = decrease_rect(bounding_box, border_size);
 
-        ctx.render_rectangle(bounding_box, colors::get_yiq_contrast(inner_color));
-        ctx.render_rectangle(base_area, inner_color);
+        ctx.render_bordered_rectangle(bounding_box, inner_color, colors::get_yiq_contrast(inner_color),
+                                      border_size / 2.0f);
         ctx.render_text(title, base_area);
 
         return model.has_just_clicked;
@@ -46,7 +55,8 @@ namespace reig::reference_widget {
 
     bool textured_button(Context& ctx, gsl::czstring title, Rectangle bounding_box,
                          int hover_texture, int base_texture) {
-        auto model = get_button_model(ctx, bounding_box);
+        auto model = get_button_model(ctx, bounding_box, bounding_box);
+        if (!ctx.is_rect_visible(bounding_box)) return model.has_just_clicked;
 
         int texture = base_texture;
         if (model.is_holding_click || model.is_hovering_over_area) {
@@ -60,6 +70,8 @@ namespace reig::reference_widget {
 
     void label(Context& ctx, char const* title, Rectangle bounding_box, text::Alignment alignment, float font_scale) {
         ctx.fit_rect_in_window(bounding_box);
+        if (!ctx.is_rect_visible(bounding_box)) return;
+
         ctx.render_text(title, bounding_box, alignment, font_scale);
     }
 
@@ -84,6 +96,7 @@ namespace reig::reference_widget {
 
     bool checkbox(Context& ctx, Rectangle bounding_box, Color base_color, bool& value) {
         auto model = get_checkbox_model(ctx, bounding_box, value);
+        if (!ctx.is_rect_visible(bounding_box)) return value;
 
         Rectangle base_area = decrease_rect(bounding_box, 4);
         Rectangle check_area = decrease_rect(base_area, 4);
@@ -97,11 +110,11 @@ namespace reig::reference_widget {
         }
 
         Color secondary_color = colors::get_yiq_contrast(base_color);
-        ctx.render_rectangle(bounding_box, secondary_color);
-        ctx.render_rectangle(base_area,
-                             model.is_hovering_over_area
-                             ? colors::lighten_color_by(base_color, 30)
-                             : base_color);
+        ctx.render_bordered_rectangle(bounding_box,
+                                      model.is_hovering_over_area
+                                      ? colors::lighten_color_by(base_color, 30)
+                                      : base_color,
+                                      secondary_color, base_area.x - bounding_box.x);
         if (value) {
             ctx.render_rectangle(check_area, secondary_color);
         }
@@ -112,6 +125,7 @@ namespace reig::reference_widget {
     bool textured_checkbox(Context& ctx, primitive::Rectangle bounding_box,
                            int base_texture, int check_texture, bool& value) {
         auto model = get_checkbox_model(ctx, bounding_box, value);
+        if (!ctx.is_rect_visible(bounding_box)) return value;
 
         Rectangle check_area = decrease_rect(bounding_box, 8);
         if (model.has_just_clicked) {
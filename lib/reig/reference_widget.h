@@ -18,6 +18,16 @@ namespace reig::reference_widget {
      */
     bool button(reig::Context& ctx, gsl::czstring title, primitive::Rectangle bounding_box, primitive::Color base_color);
 
+    namespace detail {
+        /**
+         * @brief Render a titled button, which sizes the window only by its part within the fitted area
+         * The rest of it is still moved with the window, to be cut by a clip rectangle, e.g. in a list
+         * @param fitted_area The area, which the button's top-left corner must lie in
+         */
+        bool button(Context& ctx, gsl::czstring title, primitive::Rectangle bounding_box,
+                    const primitive::Rectangle& fitted_area, primitive::Color base_color);
+    }
+
     /**
      * @brief Render a titled textured button
      * @param bounding_box Button's bouding box
@@ -69,6 +69,9 @@ namespace reig::reference_widget {
             }
         }
 
+        // A selected entry keeps taking keys, while it's hidden
+        if (!ctx.is_rect_visible(bounding_box)) return output;
+
         detail::EntryModel model{caret_area, is_selected, is_holding_click};
 
         display_entry_model(ctx, model, bounding_box, base_color, value, title);
@@ -87,12 +90,11 @@ namespace reig::reference_widget {
 
         Rectangle base_area = decrease_rect(bounding_box, 4);
 
-        ctx.render_rectangle(bounding_box, secondary_color);
         if (model.is_holding_click) {
             base_area = decrease_rect(base_area, 4);
             primary_color = colors::lighten_color_by(primary_color, 30);
         }
-        ctx.render_rectangle(base_area, primary_color);
+        ctx.render_bordered_rectangle(bounding_box, primary_color, secondary_color, base_area.x - bounding_box.x);
         if (model.is_selected) {
             float caretX = ctx.render_text(value_ref.c_str(), base_area, text::Alignment::kLeft);
 
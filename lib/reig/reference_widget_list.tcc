@@ -12,14 +12,15 @@ namespace reig::reference_widget {
         using std::end;
         auto elem_begin = begin(range);
         auto elem_end = end(range);
-        {
-            Rectangle list_area = bounding_box;
-            ctx.fit_rect_in_window(list_area);
+        Rectangle list_area = bounding_box;
+        ctx.fit_rect_in_window(list_area);
+        // The scrollbar and the items size the window only within the list's area, which is already fitted
+        if (!ctx.is_rect_visible(list_area)) return;
 
+        {
             using namespace colors::operators;
             using namespace colors::literals;
-            ctx.render_rectangle(list_area, colors::get_yiq_contrast(base_color - 50_a));
-            ctx.render_rectangle(decrease_rect(list_area, 2), base_color - 50_a);
+            ctx.render_bordered_rectangle(list_area, base_color - 50_a, colors::get_yiq_contrast(base_color - 50_a));
         }
 
         auto& scrolled = detail::get_scroll_value(scrollbar_id);
@@ -29,14 +30,18 @@ namespace reig::reference_widget {
         float y = bounding_box.y;
         float max_y = get_y2(bounding_box);
         float scrollbar_width = 30.0f;
+        // The item partially below the list is cut by the clip rectangle, both visually and for the mouse,
+        // and only its part within the list sizes the window
+        ctx.push_clip_rect(list_area);
         for (auto it = elem_begin + skipped_item_count; it != elem_end && y < max_y; ++it, y += font_height) {
-            Rectangle item_frame_box = {bounding_box.x + scrollbar_width, y, bounding_box.width, font_height};
-            trim_rect_in_other(item_frame_box, bounding_box);
+            Rectangle item_frame_box = {bounding_box.x + scrollbar_width, y,
+                                        bounding_box.width - scrollbar_width, font_height};
 
-            if (button(ctx, adapter(*it), item_frame_box, base_color)) {
+            if (detail::button(ctx, adapter(*it), item_frame_box, bounding_box, base_color)) {
                 action(it - elem_begin, *it);
             }
         }
+        ctx.pop_clip_rect();
 
         auto itemCount = elem_end - elem_begin;
         Rectangle scrollbar_area{bounding_box.x, bounding_box.y, scrollbar_width, bounding_box.height};
@@ -185,8 +185,7 @@ namespace reig::reference_widget {
     void draw_slider_model(Context& ctx, const SliderModel& model, const Rectangle& bounding_box,
                            const Color& base_color) {
         Color frame_color = colors::get_yiq_contrast(base_color);
-        ctx.render_rectangle(bounding_box, frame_color);
-        ctx.render_rectangle(model.bounding_box, base_color);
+        ctx.render_bordered_rectangle(bounding_box, base_color, frame_color, model.bounding_box.x - bounding_box.x);
 
         if (model.is_hovering_over_area) {
             frame_color = colors::lighten_color_by(frame_color, 30);
@@ -200,6 +199,7 @@ namespace reig::reference_widget {
     bool slider(Context& ctx, Rectangle bounding_box, Color base_color,
                 float& value, float min, float max, float step) {
         auto model = get_slider_model(ctx, bounding_box, value, min, max, step);
+        if (!ctx.is_rect_visible(bounding_box)) return model.has_value_changed;
 
         draw_slider_model(ctx, model, bounding_box, base_color);
 
@@ -209,6 +209,7 @@ namespace reig::reference_widget {
     bool scrollbar(Context& ctx, Rectangle bounding_box, Color base_color,
                    float& value, float view_size) {
         auto model = get_scrollbar_model(ctx, bounding_box, view_size, value);
+        if (!ctx.is_rect_visible(bounding_box)) return model.has_value_changed;
 
         draw_slider_model(ctx, model, bounding_box, base_color);
 
@@ -218,6 +219,7 @@ namespace reig::reference_widget {
     bool textured_slider(Context& ctx, Rectangle bounding_box, int base_texture, int cursor_texture,
                          float& value, float min, float max, float step) {
         auto model = get_slider_model(ctx, bounding_box, value, min, max, step);
+        if (!ctx.is_rect_visible(bounding_box)) return model.has_value_changed;
 
         ctx.render_rectangle(bounding_box, base_texture);
         ctx.render_rectangle(model.cursor_bounding_box, cursor_texture);
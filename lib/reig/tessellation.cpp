@@ -0,0 +1,51 @@
+#include "tessellation.h"
+#include <array>
+#include <cmath>
+
+using reig::primitive::Point;
+
+namespace reig::detail {
+    // The radius buckets are powers of two, each doubling the segment count up to the maximum
+    constexpr std::size_t kMinCircleSegments = 8;
+    constexpr float kMinBucketRadius = 4.0f;
+    constexpr std::size_t kCircleBucketCount = 4;
+
+    static_assert(kMinCircleSegments << (kCircleBucketCount - 1) == kMaxCircleSegments,
+                  "Circle buckets are expected to end at kMaxCircleSegments");
+
+    std::size_t get_circle_segment_count(float screen_radius) {
+        std::size_t segment_count = kMinCircleSegments;
+        for (float bucket_radius = kMinBucketRadius;
+             screen_radius > bucket_radius && segment_count < kMaxCircleSegments;
+             bucket_radius *= 4.0f) {
+            segment_count *= 2;
+        }
+        return segment_count;
+    }
+
+    std::vector<Point> make_unit_circle(std::size_t segment_count) {
+        std::vector<Point> points(segment_count);
+        const double full_turn = 2.0 * 3.14159265358979323846;
+        for (std::size_t i = 0; i < segment_count; ++i) {
+            auto angle = full_turn * static_cast<double>(i) / static_cast<double>(segment_count);
+            points[i] = {static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle))};
+        }
+        return points;
+    }
+
+    const std::vector<Point>& get_unit_circle(std::size_t segment_count) {
+        static const std::array<std::vector<Point>, kCircleBucketCount> unit_circles = [] {
+            std::array<std::vector<Point>, kCircleBucketCount> circles;
+            for (std::size_t bucket = 0; bucket < kCircleBucketCount; ++bucket) {
+                circles[bucket] = make_unit_circle(kMinCircleSegments << bucket);
+            }
+            return circles;
+        }();
+
+        std::size_t bucket = 0;
+        while (bucket + 1 < kCircleBucketCount && (kMinCircleSegments << bucket) < segment_count) {
+            ++bucket;
+        }
+        return unit_circles[bucket];
+    }
+}
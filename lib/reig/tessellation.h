@@ -0,0 +1,28 @@
+#ifndef REIG_TESSELLATION_H
+#define REIG_TESSELLATION_H
+
+#include "primitive.h"
+#include <vector>
+#include <cstddef>
+
+namespace reig::detail {
+    /**
+     * The most segments a circle is tessellated into, for the largest radius bucket
+     */
+    constexpr std::size_t kMaxCircleSegments = 64;
+
+    /**
+     * @brief Chooses the level of detail of a circle, by its radius on the screen
+     * @return A power of two, between 8 and kMaxCircleSegments
+     */
+    std::size_t get_circle_segment_count(float screen_radius);
+
+    /**
+     * @brief Returns the points of a unit circle, clockwise on the screen, starting at the angle 0
+     * The table of each segment count is computed once and cached, so no trigonometry runs per frame
+     * @param segment_count One of the values returned by get_circle_segment_count
+     */
+    const std::vector<primitive::Point>& get_unit_circle(std::size_t segment_count);
+}
+
+#endif //REIG_TESSELLATION_H
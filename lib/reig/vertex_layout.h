@@ -0,0 +1,84 @@
+#ifndef REIG_VERTEX_LAYOUT_H
+#define REIG_VERTEX_LAYOUT_H
+
+#include "primitive.h"
+#include "maths.h"
+#include <cstdint>
+#include <cmath>
+
+namespace reig::primitive {
+    /**
+     * @brief Stores the vertices as they are emitted, with float positions and texture coordinates
+     */
+    struct FloatVertexLayout {
+        using Vertex = primitive::Vertex;
+
+        static Vertex make(const primitive::Vertex& vertex) {
+            return vertex;
+        }
+    };
+
+    /**
+     * @brief A 12 byte vertex for pixel aligned interfaces
+     * Positions are whole pixels, texture coordinates are normalized to the full range of uint16_t
+     */
+    struct CompactVertex {
+        int16_t x = 0;
+        int16_t y = 0;
+        uint16_t u = 0;
+        uint16_t v = 0;
+        Color color;
+    };
+
+    static_assert(sizeof(CompactVertex) == 12, "CompactVertex is expected to be packed");
+
+    struct CompactVertexLayout {
+        using Vertex = CompactVertex;
+
+        static int16_t quantize_position(float coord) {
+            return static_cast<int16_t>(std::lround(math::clamp(coord, -32768.0f, 32767.0f)));
+        }
+
+        static uint16_t quantize_tex_coord(float coord) {
+            return static_cast<uint16_t>(std::lround(math::clamp(coord, 0.0f, 1.0f) * 65535.0f));
+        }
+
+        static Vertex make(const primitive::Vertex& vertex) {
+            return Vertex{
+                    quantize_position(vertex.position.x), quantize_position(vertex.position.y),
+                    quantize_tex_coord(vertex.texCoord.x), quantize_tex_coord(vertex.texCoord.y),
+                    vertex.color
+            };
+        }
+    };
+
+    // Accessors for backends, which read the vertices on the CPU regardless of the layout
+    inline Point get_position(const Vertex& vertex) {
+        return vertex.position;
+    }
+
+    inline Point get_tex_coord(const Vertex& vertex) {
+        return vertex.texCoord;
+    }
+
+    inline Point get_position(const CompactVertex& vertex) {
+        return Point{static_cast<float>(vertex.x), static_cast<float>(vertex.y)};
+    }
+
+    inline Point get_tex_coord(const CompactVertex& vertex) {
+        return Point{vertex.u / 65535.0f, vertex.v / 65535.0f};
+    }
+
+    /**
+     * The layout in which draw lists store their vertices, chosen at compile time
+     */
+#ifdef REIG_COMPACT_VERTICES
+    using VertexLayout = CompactVertexLayout;
+#else
+    using VertexLayout = FloatVertexLayout;
+#endif
+
+    using DrawVertex = VertexLayout::Vertex;
+}
+
+#endif //REIG_VERTEX_LAYOUT_H
@@ -1,15 +1,26 @@
 #ifndef REIG_WINDOW_H
 #define REIG_WINDOW_H
 
-#include "primitive.h"
+#include "draw_list.h"
 #include "gsl.h"
 
 namespace reig::detail {
+    /**
+     * @brief Where a text recorded in a cached window ended, keyed by the hash of the render's arguments
+     */
+    struct CachedTextEnd {
+        std::uint64_t key = 0;
+        float end_x = 0.0f;
+    };
+
     class Window {
     public:
         Window(gsl::czstring id, gsl::czstring title, float x, float y,
-               float width, float height, float title_bar_height)
-                : _title{title}, _id{id}, _x{x}, _y{y}, _width{width}, _height{height},
+               float width, float height, float title_bar_height,
+               std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+                : _draw_data{resource}, _cached_draw_data{std::pmr::get_default_resource()},
+                  _cached_chrome{std::pmr::get_default_resource()},
+                  _title{title}, _id{id}, _x{x}, _y{y}, _width{width}, _height{height},
                   _title_bar_height{title_bar_height} {}
 
         DrawData& draw_data() {
@@ -20,6 +31,43 @@ namespace reig::detail {
             return _draw_data;
         }
 
+        /**
+         * The window's geometry, as it was last emitted by its widgets. Outlives the frames,
+         * so it can be reused while the widgets render the same
+         */
+        DrawData& cached_draw_data() {
+            return _cached_draw_data;
+        }
+
+        /**
+         * The hash of the renders, of which the cached geometry was made. Zero if nothing is cached
+         */
+        std::uint64_t fingerprint() const { return _fingerprint; }
+
+        void set_fingerprint(std::uint64_t fingerprint) { _fingerprint = fingerprint; }
+
+        /**
+         * The ends of the texts recorded in the window, in the order of their renders. Kept between the frames,
+         * so an unchanged text isn't laid out again only to tell the widget where it ended
+         */
+        std::vector<CachedTextEnd>& cached_text_ends() {
+            return _cached_text_ends;
+        }
+
+        /**
+         * The window's header, minimize button and frame, as they were last generated
+         */
+        DrawData& cached_chrome() {
+            return _cached_chrome;
+        }
+
+        /**
+         * The hash of the window's state, of which the cached chrome was made. Zero if nothing is cached
+         */
+        std::uint64_t chrome_fingerprint() const { return _chrome_fingerprint; }
+
+        void set_chrome_fingerprint(std::uint64_t chrome_fingerprint) { _chrome_fingerprint = chrome_fingerprint; }
+
         gsl::czstring title() const {
             return _title;
         }
@@ -54,12 +102,66 @@ namespace reig::detail {
 
         void set_collapsed(bool is_collapsed) { _is_collapsed = is_collapsed; }
 
+        /**
+         * Whether the window was covered by an opaque window above it in the last frame, so its widgets are told
+         * their content is hidden, and their renders are only recorded until it's known if it's still covered
+         */
+        bool is_occluded() const { return _is_occluded; }
+
+        void set_occluded(bool is_occluded) { _is_occluded = is_occluded; }
+
+        /**
+         * The range of the occluded window's recorded renders, in the context's deferred draw calls
+         */
+        std::size_t first_deferred_call() const { return _first_deferred_call; }
+
+        std::size_t deferred_call_count() const { return _deferred_call_count; }
+
+        void set_deferred_calls(std::size_t first_call, std::size_t call_count) {
+            _first_deferred_call = first_call;
+            _deferred_call_count = call_count;
+        }
+
+        /**
+         * Whether the window was guessed to be covered, but was drawn, so its widgets may have skipped some content.
+         * The window is damaged again in the next frame, when it's drawn in full
+         */
+        bool is_incomplete() const { return _is_incomplete; }
+
+        void set_incomplete(bool is_incomplete) { _is_incomplete = is_incomplete; }
+
         bool is_queued() const { return _is_queued; }
 
         void set_queued(bool is_queued) { _is_queued = is_queued; }
 
+        /**
+         * The content hash of the window's chrome in the last frame, the chrome's draw data is shared by the windows
+         */
+        std::uint64_t chrome_hash() const { return _chrome_hash; }
+
+        void set_chrome_hash(std::uint64_t chrome_hash) { _chrome_hash = chrome_hash; }
+
+        /**
+         * The window's full rect on the screen, as it was rendered in the last frame. Empty before the first one
+         */
+        const primitive::Rectangle& rendered_rect() const { return _rendered_rect; }
+
+        void set_rendered_rect(const primitive::Rectangle& rendered_rect) { _rendered_rect = rendered_rect; }
+
+        /**
+         * The window's position in the z-order in the last frame, 0 is the topmost one
+         */
+        std::size_t rendered_layer() const { return _rendered_layer; }
+
+        void set_rendered_layer(std::size_t rendered_layer) { _rendered_layer = rendered_layer; }
+
     private:
         DrawData _draw_data;
+        DrawData _cached_draw_data;
+        std::uint64_t _fingerprint = 0;
+        std::vector<CachedTextEnd> _cached_text_ends;
+        DrawData _cached_chrome;
+        std::uint64_t _chrome_fingerprint = 0;
         gsl::czstring _title = "";
         gsl::czstring _id = nullptr;
         float _x = 0.0f;
@@ -69,6 +171,13 @@ namespace reig::detail {
         float _title_bar_height = 0.0f;
         bool _is_queued = true;
         bool _is_collapsed = false;
+        bool _is_occluded = false;
+        bool _is_incomplete = false;
+        std::size_t _first_deferred_call = 0;
+        std::size_t _deferred_call_count = 0;
+        std::uint64_t _chrome_hash = 0;
+        primitive::Rectangle _rendered_rect;
+        std::size_t _rendered_layer = 0;
     };
 
     /**